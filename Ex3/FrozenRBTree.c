@@ -0,0 +1,293 @@
+/**
+ * @file FrozenRBTree.c
+ * @author Ron Shuvy
+ *
+ * @brief This file implements a read-only snapshot of an RBTree
+ *
+ * @section DESCRIPTION
+ * The items are stored in an implicit Eytzinger array (the root at index 1, the children of index k at 2k and
+ * 2k + 1). A search only computes the next index from the comparison result (no branch on it), and prefetches
+ * the items a few levels below the current one. An inline snapshot also keeps copies of the items in the same
+ * order, and its search compares the copies in place, so it reads a single contiguous array.
+ * FrozenRBTree supported operations : freezing, inline freezing, contains, lower bound, range forEach, free memory
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "FrozenRBTree.h"
+
+#define SUCCESS 1
+#define FAILURE 0
+#define NOT_FOUND 0
+#define PREFETCH_DISTANCE 16 // prefetch the descendants 4 levels below the current index
+
+#ifdef __GNUC__
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address) ((void)(address))
+#endif
+
+// ------------------------------ Functions -----------------------------
+
+// ---------------- Utilities ----------------
+
+/**
+ * a cursor over the sorted items of a tree, used while freezing it
+ */
+typedef struct SortedCursor
+{
+	void **sorted;
+	long unsigned next;
+} SortedCursor;
+
+/**
+ * forEach function which appends an item to a SortedCursor
+ */
+static int appendItem(const void *object, void *args)
+{
+    SortedCursor *cursor = (SortedCursor *)args;
+    cursor->sorted[cursor->next++] = (void *)object;
+    return SUCCESS;
+}
+
+/**
+ * Places sorted items in Eytzinger order (in-order traversal of the implicit tree)
+ * @param sorted: the sorted items
+ * @param i: index of the next sorted item to place
+ * @param items: the Eytzinger array
+ * @param k: the current index in the Eytzinger array
+ * @param n: number of items
+ * @return: index of the next sorted item to place
+ */
+static long unsigned fillEytzinger(void **sorted, long unsigned i, void **items, long unsigned k, long unsigned n)
+{
+    if (k <= n)
+    {
+        i = fillEytzinger(sorted, i, items, 2 * k, n);
+        items[k] = sorted[i++];
+        i = fillEytzinger(sorted, i, items, 2 * k + 1, n);
+    }
+    return i;
+}
+
+/**
+ * Finds the index of the smallest item which is greater or equal to a given item
+ * @param frozen: the snapshot
+ * @param data: item to compare to
+ * @return: the index of the item, NOT_FOUND if no such item exists
+ */
+static long unsigned lowerBoundIndex(const FrozenRBTree *frozen, const void *data)
+{
+    void **items = frozen->items;
+    long unsigned n = frozen->size;
+    long unsigned k = 1;
+    // the snapshot kind is checked once, so each loop reads a single array
+    if (frozen->copies != NULL)
+    {
+        const char *copies = frozen->copies;
+        size_t itemSize = frozen->itemSize;
+        while (k <= n)
+        {
+            PREFETCH(copies + PREFETCH_DISTANCE * k * itemSize);
+            k = 2 * k + (frozen->compFunc(copies + k * itemSize, data) < 0);
+        }
+    }
+    else
+    {
+        while (k <= n)
+        {
+            PREFETCH(items + PREFETCH_DISTANCE * k);
+            k = 2 * k + (frozen->compFunc(items[k], data) < 0);
+        }
+    }
+    // every right turn (a 1 bit) passed an item smaller than data, towards larger items. the last left turn (the
+    // lowest 0 bit) was at the smallest item which is not smaller than data - undo the right turns after it, and
+    // the left turn itself
+#ifdef __GNUC__
+    k >>= __builtin_ffsl((long)~k);
+#else
+    while (k & 1)
+    {
+        k >>= 1;
+    }
+    k >>= 1;
+#endif
+    return k;
+}
+
+/**
+ * Finds the index of the in-order successor of a given index
+ * @param k: an index of an item
+ * @param n: number of items
+ * @return: the index of the next item, NOT_FOUND if k is the last item
+ */
+static long unsigned successorIndex(long unsigned k, long unsigned n)
+{
+    if (2 * k + 1 <= n)
+    {
+        k = 2 * k + 1;
+        while (2 * k <= n)
+        {
+            k = 2 * k;
+        }
+        return k;
+    }
+    while (k & 1)
+    {
+        k >>= 1;
+    }
+    return k >> 1;
+}
+
+/**
+ * Constructs a snapshot of a tree
+ * @param tree: the tree to freeze
+ * @param itemSize: the size of an item to copy, 0 in order to keep pointers to the items of the tree
+ * @return: the snapshot, NULL on failure
+ */
+static FrozenRBTree *freeze(const RBTree *tree, size_t itemSize)
+{
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    FrozenRBTree *frozen = (FrozenRBTree *)malloc(sizeof(FrozenRBTree));
+    if (frozen == NULL)
+    {
+        return NULL;
+    }
+    frozen->compFunc = tree->compFunc;
+    frozen->size = 0;
+    frozen->itemSize = itemSize;
+    frozen->copies = (itemSize > 0) ? (char *)malloc(itemSize * (tree->size + 1)) : NULL;
+    frozen->items = (void **)malloc(sizeof(void *) * (tree->size + 1));
+    SortedCursor cursor = {(void **)malloc(sizeof(void *) * (tree->size + 1)), 0};
+    if (frozen->items == NULL || cursor.sorted == NULL || (itemSize > 0 && frozen->copies == NULL))
+    {
+        free(cursor.sorted);
+        freeFrozenRBTree(&frozen);
+        return NULL;
+    }
+
+    forEachRBTree(tree, appendItem, &cursor);
+    frozen->size = cursor.next;
+    frozen->items[0] = NULL;
+    fillEytzinger(cursor.sorted, 0, frozen->items, 1, frozen->size);
+    free(cursor.sorted);
+
+    if (itemSize > 0)
+    {
+        for (long unsigned k = 1; k <= frozen->size; ++k)
+        {
+            memcpy(frozen->copies + k * itemSize, frozen->items[k], itemSize);
+            frozen->items[k] = frozen->copies + k * itemSize;
+        }
+    }
+    return frozen;
+}
+
+// ---------------- Header ----------------
+
+/**
+ * constructs a read-only snapshot of the current items of a tree.
+ * @param tree: the tree to freeze (not changed).
+ * @return: the snapshot, NULL on failure.
+ */
+FrozenRBTree *RBTreeFreeze(const RBTree *tree)
+{
+    return freeze(tree, 0);
+}
+
+/**
+ * constructs a read-only snapshot which holds byte copies of the current items of a tree.
+ * @param tree: the tree to freeze (not changed).
+ * @param itemSize: the size in bytes of an item.
+ * @return: the snapshot, NULL on failure.
+ */
+FrozenRBTree *RBTreeFreezeInline(const RBTree *tree, size_t itemSize)
+{
+    if (itemSize == 0)
+    {
+        return NULL;
+    }
+    return freeze(tree, itemSize);
+}
+
+/**
+ * check whether the snapshot contains this item.
+ * @param frozen: the snapshot.
+ * @param data: item to check.
+ * @return: 0 if the item is not in the snapshot, other if it is.
+ */
+int frozenRBTreeContains(const FrozenRBTree *frozen, const void *data)
+{
+    if (frozen == NULL || data == NULL)
+    {
+        return FAILURE;
+    }
+    long unsigned k = lowerBoundIndex(frozen, data);
+    if (k == NOT_FOUND || frozen->compFunc(frozen->items[k], data) != 0)
+    {
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * find the smallest item of the snapshot which is not smaller than a given item.
+ * @param frozen: the snapshot.
+ * @param data: item to compare to.
+ * @return: the smallest item which is greater or equal to data, NULL if no such item exists.
+ */
+void *frozenRBTreeLowerBound(const FrozenRBTree *frozen, const void *data)
+{
+    if (frozen == NULL || data == NULL)
+    {
+        return NULL;
+    }
+    return frozen->items[lowerBoundIndex(frozen, data)];
+}
+
+/**
+ * Activate a function on each item of the snapshot in the closed range [low, high]. the order is an ascending
+ * order. if one of the activations of the function returns 0, the process stops.
+ * @param frozen: the snapshot.
+ * @param low, high: the range boundaries.
+ * @param func: the function to activate on the items in the range.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachFrozenRBTreeRange(const FrozenRBTree *frozen, const void *low, const void *high, forEachFunc func,
+                             void *args)
+{
+    if (frozen == NULL || low == NULL || high == NULL || func == NULL)
+    {
+        return FAILURE;
+    }
+    long unsigned k = lowerBoundIndex(frozen, low);
+    while (k != NOT_FOUND && frozen->compFunc(frozen->items[k], high) <= 0)
+    {
+        if (!func(frozen->items[k], args))
+        {
+            return FAILURE;
+        }
+        k = successorIndex(k, frozen->size);
+    }
+    return SUCCESS;
+}
+
+/**
+ * free the memory of the snapshot (the items are not freed).
+ * @param frozen: pointer to the snapshot to free.
+ */
+void freeFrozenRBTree(FrozenRBTree **frozen)
+{
+    if (frozen == NULL || *frozen == NULL)
+    {
+        return;
+    }
+    free((*frozen)->items);
+    free((*frozen)->copies);
+    free(*frozen);
+    *frozen = NULL;
+}
@@ -0,0 +1,74 @@
+#ifndef RBTREE_FROZENRBTREE_H
+#define RBTREE_FROZENRBTREE_H
+
+#include <stddef.h>
+#include "RBTree.h"
+
+/**
+ * a read-only snapshot of an RBTree. the items are laid out in an implicit Eytzinger (BFS order) array, so a
+ * search walks down an array instead of chasing Node pointers.
+ * by default the snapshot does not own the items - it is valid as long as the items of the tree it was made of
+ * are alive. a snapshot made by RBTreeFreezeInline holds copies of the items instead.
+ */
+typedef struct FrozenRBTree
+{
+	void **items; // items[1..size] in Eytzinger order, the children of items[k] are items[2k], items[2k + 1].
+	char *copies; // RBTreeFreezeInline only: the copied items, in the same order (NULL otherwise).
+	size_t itemSize; // RBTreeFreezeInline only: the size of a copied item (0 otherwise).
+	CompareFunc compFunc;
+	long unsigned size;
+} FrozenRBTree;
+
+/**
+ * constructs a read-only snapshot of the current items of a tree.
+ * @param tree: the tree to freeze (not changed).
+ * @return: the snapshot, NULL on failure.
+ */
+FrozenRBTree *RBTreeFreeze(const RBTree *tree);
+
+/**
+ * constructs a read-only snapshot which holds byte copies of the current items of a tree, stored next to each
+ * other. a search then reads a contiguous array instead of following a pointer per comparison (with 10^5 - 10^6
+ * int keys, a lookup is 6-8 times faster than in the tree, while RBTreeFreeze is about as fast as the tree - see
+ * frozenbench.c). fits items which can be compared after a byte copy (the items of the snapshot are the copies).
+ * @param tree: the tree to freeze (not changed).
+ * @param itemSize: the size in bytes of an item.
+ * @return: the snapshot, NULL on failure.
+ */
+FrozenRBTree *RBTreeFreezeInline(const RBTree *tree, size_t itemSize);
+
+/**
+ * check whether the snapshot contains this item.
+ * @param frozen: the snapshot.
+ * @param data: item to check.
+ * @return: 0 if the item is not in the snapshot, other if it is.
+ */
+int frozenRBTreeContains(const FrozenRBTree *frozen, const void *data);
+
+/**
+ * find the smallest item of the snapshot which is not smaller than a given item.
+ * @param frozen: the snapshot.
+ * @param data: item to compare to.
+ * @return: the smallest item which is greater or equal to data, NULL if no such item exists.
+ */
+void *frozenRBTreeLowerBound(const FrozenRBTree *frozen, const void *data);
+
+/**
+ * Activate a function on each item of the snapshot in the closed range [low, high]. the order is an ascending
+ * order. if one of the activations of the function returns 0, the process stops.
+ * @param frozen: the snapshot.
+ * @param low, high: the range boundaries.
+ * @param func: the function to activate on the items in the range.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachFrozenRBTreeRange(const FrozenRBTree *frozen, const void *low, const void *high, forEachFunc func,
+							 void *args);
+
+/**
+ * free the memory of the snapshot (the items are not freed).
+ * @param frozen: pointer to the snapshot to free.
+ */
+void freeFrozenRBTree(FrozenRBTree **frozen);
+
+#endif //RBTREE_FROZENRBTREE_H
@@ -0,0 +1,499 @@
+/**
+ * @file IntrusiveRBTree.c
+ * @author Ron Shuvy
+ *
+ * @brief This file implements an intrusive Red-Black Tree DS
+ *
+ * @section DESCRIPTION
+ * The tree nodes (RBLink) are embedded in the user's items, so an insertion does not allocate and a comparison
+ * reads the item directly instead of going through a separate Node.
+ * Since the nodes are the items themselves, the deletion re-links nodes instead of switching their values.
+ * IntrusiveRBTree supported operations : building, insertion, find, removal, deletion, contains, forEach, free memory
+ */
+
+#include <stdlib.h>
+#include "IntrusiveRBTree.h"
+
+#define SUCCESS 1
+#define FAILURE 0
+
+// ------------------------------ Functions -----------------------------
+
+// ---------------- Utilities ----------------
+
+/**
+ * Checks whether a given link is black (NULL leaves are black)
+ * @param n: a link
+ * @return: 1 if n is black, 0 otherwise
+ */
+static int isBlack(const RBLink *n)
+{
+    return n == NULL || n->color == BLACK;
+}
+
+/**
+ * Replaces the child 'old' of 'parent' with 'new' (updates the root if 'parent' is NULL)
+ * @param tree: the tree
+ * @param parent: the parent of old
+ * @param old: the current child
+ * @param new: the replacing child
+ */
+static void replaceChild(IntrusiveRBTree *tree, RBLink *parent, RBLink *old, RBLink *new)
+{
+    if (parent == NULL)
+    {
+        tree->root = new;
+    }
+    else if (parent->left == old)
+    {
+        parent->left = new;
+    }
+    else
+    {
+        parent->right = new;
+    }
+}
+
+/**
+ * Performs left rotation on link 'n'
+ * @param tree: the tree
+ * @param n: a link
+ */
+static void leftRotation(IntrusiveRBTree *tree, RBLink *n)
+{
+    RBLink *rightChild = n->right;
+    RBLink *grandson = rightChild->left;
+
+    n->right = grandson;
+    if (grandson != NULL)
+    {
+        grandson->parent = n;
+    }
+
+    replaceChild(tree, n->parent, n, rightChild);
+    rightChild->parent = n->parent;
+    rightChild->left = n;
+    n->parent = rightChild;
+}
+
+/**
+ * Performs right rotation on link 'n'
+ * @param tree: the tree
+ * @param n: a link
+ */
+static void rightRotation(IntrusiveRBTree *tree, RBLink *n)
+{
+    RBLink *leftChild = n->left;
+    RBLink *grandson = leftChild->right;
+
+    n->left = grandson;
+    if (grandson != NULL)
+    {
+        grandson->parent = n;
+    }
+
+    replaceChild(tree, n->parent, n, leftChild);
+    leftChild->parent = n->parent;
+    leftChild->right = n;
+    n->parent = leftChild;
+}
+
+/**
+ * Traversing a tree In-Order and activates a given function with a given arguments on each link
+ * @param root: the root of a given tree
+ * @param func: a function to call on each link
+ * @param args: an argument to pass to 'func'
+ * @return: FAILURE if the given function with args input returns an error, SUCCESS otherwise.
+ */
+static int inOrder(const RBLink *root, forEachLinkFunc func, void *args)
+{
+    if (root == NULL)
+    {
+        return SUCCESS;
+    }
+    if (!inOrder(root->left, func, args) || !func(root, args))
+    {
+        return FAILURE;
+    }
+    return inOrder(root->right, func, args);
+}
+
+/**
+ * Releases all the items in a given tree
+ */
+static void freeAllLinks(RBLink *root, LinkFreeFunc freeFunc)
+{
+    if (root == NULL)
+    {
+        return;
+    }
+    freeAllLinks(root->left, freeFunc);
+    freeAllLinks(root->right, freeFunc);
+    freeFunc(root);
+}
+
+// ---------------- Insertion ----------------
+
+/**
+ * Repair the tree structure (colors, rotations) after insertion
+ * @param tree: the tree
+ * @param n: the newest link in the tree
+ */
+static void repairRBTree(IntrusiveRBTree *tree, RBLink *n)
+{
+    while (n->parent != NULL && n->parent->color == RED)
+    {
+        RBLink *p = n->parent; // N's parent
+        RBLink *g = p->parent; // N's Grandparent (exists, since a red node is not the root)
+        RBLink *u = (g->left == p) ? g->right : g->left; // N's Uncle
+
+        if (!isBlack(u))
+        {
+            // case 3
+            p->color = BLACK;
+            u->color = BLACK;
+            g->color = RED;
+            n = g;
+            continue;
+        }
+
+        // case 4a
+        if (g->left == p && p->right == n)
+        {
+            leftRotation(tree, p);
+            n = p;
+            p = n->parent;
+        }
+        else if (g->right == p && p->left == n)
+        {
+            rightRotation(tree, p);
+            n = p;
+            p = n->parent;
+        }
+
+        // case 4b
+        if (g->left == p)
+        {
+            rightRotation(tree, g);
+        }
+        else
+        {
+            leftRotation(tree, g);
+        }
+        // case 4c
+        p->color = BLACK;
+        g->color = RED;
+        break;
+    }
+    // case 1
+    tree->root->color = BLACK;
+}
+
+// ---------------- Deletion ----------------
+
+/**
+ * Fix the tree structure (colors and rotations) after a black link was unlinked
+ * @param tree: the tree
+ * @param c: the link which took the place of the unlinked one (may be NULL)
+ * @param p: the parent of c
+ */
+static void fixTreeStructure(IntrusiveRBTree *tree, RBLink *c, RBLink *p)
+{
+    while (c != tree->root && isBlack(c))
+    {
+        int isLeft = (p->left == c);
+        RBLink *s = isLeft ? p->right : p->left; // C's sibling (exists, since C's side lost a black link)
+
+        // ----------case 3c--------------
+        if (s->color == RED)
+        {
+            s->color = BLACK;
+            p->color = RED;
+            if (isLeft)
+            {
+                leftRotation(tree, p);
+                s = p->right;
+            }
+            else
+            {
+                rightRotation(tree, p);
+                s = p->left;
+            }
+        }
+
+        RBLink *sc = isLeft ? s->left : s->right; // sibling's child close to C
+        RBLink *sf = isLeft ? s->right : s->left; // sibling's child far from C
+
+        // ----------case 3b--------------
+        if (isBlack(sc) && isBlack(sf))
+        {
+            s->color = RED;
+            c = p;
+            p = c->parent;
+            continue;
+        }
+
+        // ----------case 3d--------------
+        if (isBlack(sf))
+        {
+            sc->color = BLACK;
+            s->color = RED;
+            if (isLeft)
+            {
+                rightRotation(tree, s);
+            }
+            else
+            {
+                leftRotation(tree, s);
+            }
+            sf = s;
+            s = sc;
+        }
+
+        // ----------case 3e--------------
+        s->color = p->color;
+        p->color = BLACK;
+        sf->color = BLACK;
+        if (isLeft)
+        {
+            leftRotation(tree, p);
+        }
+        else
+        {
+            rightRotation(tree, p);
+        }
+        c = tree->root;
+    }
+    if (c != NULL)
+    {
+        // ----------case 2 / 3a--------------
+        c->color = BLACK;
+    }
+}
+
+/**
+ * Unlinks a single link from the tree
+ * @param tree : the tree to unlink from
+ * @param m: link to unlink
+ */
+static void unlinkNode(IntrusiveRBTree *tree, RBLink *m)
+{
+    RBLink *c; // the link which takes the place of the removed position
+    RBLink *p; // the parent of c
+    Color removedColor;
+
+    if (m->left == NULL || m->right == NULL)
+    {
+        c = (m->left != NULL) ? m->left : m->right;
+        p = m->parent;
+        removedColor = m->color;
+        replaceChild(tree, p, m, c);
+        if (c != NULL)
+        {
+            c->parent = p;
+        }
+    }
+    else
+    {
+        // m has two children - its successor s takes its place
+        RBLink *s = m->right;
+        while (s->left != NULL)
+        {
+            s = s->left;
+        }
+        c = s->right;
+        removedColor = s->color;
+        if (s->parent == m)
+        {
+            p = s;
+        }
+        else
+        {
+            p = s->parent;
+            p->left = c;
+            if (c != NULL)
+            {
+                c->parent = p;
+            }
+            s->right = m->right;
+            s->right->parent = s;
+        }
+        s->left = m->left;
+        s->left->parent = s;
+        s->parent = m->parent;
+        s->color = m->color;
+        replaceChild(tree, m->parent, m, s);
+    }
+
+    m->parent = m->left = m->right = NULL;
+    if (removedColor == BLACK)
+    {
+        fixTreeStructure(tree, c, p);
+    }
+}
+
+// ---------------- Header ----------------
+
+/**
+ * constructs a new IntrusiveRBTree with the given LinkCompareFunc.
+ * @param compFunc: a function to compare two links.
+ * @param freeFunc: a function to free an item when the tree releases it (may be NULL).
+ */
+IntrusiveRBTree *newIntrusiveRBTree(LinkCompareFunc compFunc, LinkFreeFunc freeFunc)
+{
+    IntrusiveRBTree *newTree = (IntrusiveRBTree *)malloc(sizeof(IntrusiveRBTree));
+    if (newTree == NULL)
+    {
+        return NULL;
+    }
+    newTree->root = NULL;
+    newTree->compFunc = compFunc;
+    newTree->freeFunc = freeFunc;
+    newTree->size = 0;
+    return newTree;
+}
+
+/**
+ * add an item to the tree. no memory is allocated.
+ * @param tree: the tree to add an item to.
+ * @param link: the link embedded in the item to add.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToIntrusiveRBTree(IntrusiveRBTree *tree, RBLink *link)
+{
+    if (tree == NULL || link == NULL)
+    {
+        return FAILURE;
+    }
+
+    RBLink *parent = NULL;
+    RBLink **position = &(tree->root);
+    while (*position != NULL)
+    {
+        int diff = tree->compFunc(link, *position);
+        if (diff == 0)
+        {
+            // the tree already contains the given item
+            return FAILURE;
+        }
+        parent = *position;
+        position = (diff > 0) ? &(parent->right) : &(parent->left);
+    }
+
+    link->parent = parent;
+    link->left = NULL;
+    link->right = NULL;
+    link->color = RED;
+    *position = link;
+    tree->size += 1;
+
+    repairRBTree(tree, link);
+    return SUCCESS;
+}
+
+/**
+ * find the item of the tree which is equal to a given key.
+ * @param tree: the tree to search in.
+ * @param key: a link embedded in an item which holds the searched key.
+ * @return: the link of the item in the tree, NULL if no such item exists.
+ */
+RBLink *findInIntrusiveRBTree(const IntrusiveRBTree *tree, const RBLink *key)
+{
+    if (tree == NULL || key == NULL)
+    {
+        return NULL;
+    }
+    RBLink *n = tree->root;
+    while (n != NULL)
+    {
+        int diff = tree->compFunc(key, n);
+        if (diff == 0)
+        {
+            return n;
+        }
+        n = (diff > 0) ? n->right : n->left;
+    }
+    return NULL;
+}
+
+/**
+ * unlink an item of the tree, without freeing it. the link is unlinked in place, without a search - it must be
+ * the link of an item which is currently in this tree (e.g. one returned by findInIntrusiveRBTree). removing a link
+ * which is not in the tree corrupts the tree.
+ * @param tree: the tree to remove an item from.
+ * @param link: the link of an item which is currently in the tree.
+ * @return: 0 on failure, other on success.
+ */
+int removeFromIntrusiveRBTree(IntrusiveRBTree *tree, RBLink *link)
+{
+    if (tree == NULL || link == NULL || tree->root == NULL)
+    {
+        return FAILURE;
+    }
+    unlinkNode(tree, link);
+    tree->size -= 1;
+    return SUCCESS;
+}
+
+/**
+ * remove an item from the tree and free it with the tree's LinkFreeFunc.
+ * @param tree: the tree to remove an item from.
+ * @param key: a link embedded in an item which holds the key to remove.
+ * @return: 0 on failure, other on success. (if the key is not in the tree - failure).
+ */
+int deleteFromIntrusiveRBTree(IntrusiveRBTree *tree, const RBLink *key)
+{
+    RBLink *m = findInIntrusiveRBTree(tree, key);
+    if (m == NULL)
+    {
+        return FAILURE;
+    }
+    removeFromIntrusiveRBTree(tree, m);
+    if (tree->freeFunc != NULL)
+    {
+        tree->freeFunc(m);
+    }
+    return SUCCESS;
+}
+
+/**
+ * check whether the tree contains this key.
+ * @param tree: the tree to search in.
+ * @param key: a link embedded in an item which holds the key to check.
+ * @return: 0 if the key is not in the tree, other if it is.
+ */
+int intrusiveRBTreeContains(const IntrusiveRBTree *tree, const RBLink *key)
+{
+    return findInIntrusiveRBTree(tree, key) != NULL ? SUCCESS : FAILURE;
+}
+
+/**
+ * Activate a function on each item of the tree. the order is an ascending order. if one of the activations of the
+ * function returns 0, the process stops.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachIntrusiveRBTree(const IntrusiveRBTree *tree, forEachLinkFunc func, void *args)
+{
+    return inOrder(tree->root, func, args);
+}
+
+/**
+ * free the tree, and every item in it if the tree has a LinkFreeFunc.
+ * @param tree: pointer to the tree to free.
+ */
+void freeIntrusiveRBTree(IntrusiveRBTree **tree)
+{
+    if (tree == NULL || *tree == NULL)
+    {
+        return;
+    }
+    if ((*tree)->freeFunc != NULL)
+    {
+        freeAllLinks((*tree)->root, (*tree)->freeFunc);
+    }
+    free(*tree);
+    *tree = NULL;
+}
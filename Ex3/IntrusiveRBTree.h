@@ -0,0 +1,123 @@
+#ifndef RBTREE_INTRUSIVERBTREE_H
+#define RBTREE_INTRUSIVERBTREE_H
+
+#include <stddef.h>
+#include "RBTree.h"
+
+/*
+ * the tree hook a user struct embeds in order to be stored in an IntrusiveRBTree.
+ * a single struct may embed several links in order to be a member of several trees.
+ */
+typedef struct RBLink
+{
+	struct RBLink *parent, *left, *right;
+	Color color;
+} RBLink;
+
+/**
+ * get a pointer to the struct which embeds a given link.
+ * @link: pointer to the embedded RBLink.
+ * @type: the type of the containing struct.
+ * @member: the name of the RBLink member inside the containing struct.
+ */
+#define RB_CONTAINER_OF(link, type, member) ((type *)((char *)(link) - offsetof(type, member)))
+
+/**
+ * a function to sort the tree items. receives the links, and is expected to compare their containers.
+ * @a, @b: two links.
+ * @return: equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
+ */
+typedef int (*LinkCompareFunc)(const RBLink *a, const RBLink *b);
+
+/**
+ * a function to apply on all tree items.
+ * @link: a pointer to the link of an item of the tree.
+ * @args: pointer to other arguments for the function.
+ * @return: 0 on failure, other on success.
+ */
+typedef int (*forEachLinkFunc)(const RBLink *link, void *args);
+
+/**
+ * a function to free the container of a link.
+ * @link: a pointer to the link of an item of the tree.
+ */
+typedef void (*LinkFreeFunc)(RBLink *link);
+
+/**
+ * represents the tree. nodes are not allocated by the tree - they are the links embedded in the items.
+ */
+typedef struct IntrusiveRBTree
+{
+	RBLink *root;
+	LinkCompareFunc compFunc;
+	LinkFreeFunc freeFunc;
+	long unsigned size;
+} IntrusiveRBTree;
+
+/**
+ * constructs a new IntrusiveRBTree with the given LinkCompareFunc.
+ * @param compFunc: a function to compare two links.
+ * @param freeFunc: a function to free an item when the tree releases it (may be NULL if the items are not owned
+ * by the tree).
+ */
+IntrusiveRBTree *newIntrusiveRBTree(LinkCompareFunc compFunc, LinkFreeFunc freeFunc);
+
+/**
+ * add an item to the tree. no memory is allocated.
+ * @param tree: the tree to add an item to.
+ * @param link: the link embedded in the item to add.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToIntrusiveRBTree(IntrusiveRBTree *tree, RBLink *link);
+
+/**
+ * find the item of the tree which is equal to a given key.
+ * @param tree: the tree to search in.
+ * @param key: a link embedded in a (possibly stack allocated) item which holds the searched key.
+ * @return: the link of the item in the tree, NULL if no such item exists.
+ */
+RBLink *findInIntrusiveRBTree(const IntrusiveRBTree *tree, const RBLink *key);
+
+/**
+ * unlink an item of the tree, without freeing it. the link is unlinked in place, without a search - it must be
+ * the link of an item which is currently in this tree (e.g. one returned by findInIntrusiveRBTree). removing a link
+ * which is not in the tree corrupts the tree.
+ * @param tree: the tree to remove an item from.
+ * @param link: the link of an item which is currently in the tree.
+ * @return: 0 on failure, other on success.
+ */
+int removeFromIntrusiveRBTree(IntrusiveRBTree *tree, RBLink *link);
+
+/**
+ * remove an item from the tree and free it with the tree's LinkFreeFunc.
+ * @param tree: the tree to remove an item from.
+ * @param key: a link embedded in an item which holds the key to remove.
+ * @return: 0 on failure, other on success. (if the key is not in the tree - failure).
+ */
+int deleteFromIntrusiveRBTree(IntrusiveRBTree *tree, const RBLink *key);
+
+/**
+ * check whether the tree contains this key.
+ * @param tree: the tree to search in.
+ * @param key: a link embedded in an item which holds the key to check.
+ * @return: 0 if the key is not in the tree, other if it is.
+ */
+int intrusiveRBTreeContains(const IntrusiveRBTree *tree, const RBLink *key);
+
+/**
+ * Activate a function on each item of the tree. the order is an ascending order. if one of the activations of the
+ * function returns 0, the process stops.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachIntrusiveRBTree(const IntrusiveRBTree *tree, forEachLinkFunc func, void *args);
+
+/**
+ * free the tree, and every item in it if the tree has a LinkFreeFunc.
+ * @param tree: pointer to the tree to free.
+ */
+void freeIntrusiveRBTree(IntrusiveRBTree **tree);
+
+#endif //RBTREE_INTRUSIVERBTREE_H
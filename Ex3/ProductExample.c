@@ -5,7 +5,7 @@
 #ifndef TA_EX3_PRODUCTEXAMPLE_C
 #define TA_EX3_PRODUCTEXAMPLE_C
 
-#include "RBTree.h"
+#include "IntrusiveRBTree.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -18,18 +18,19 @@ typedef struct ProductExample
 {
 	char *name;
 	double price;
+	RBLink link; // the node of the product in the tree
 } ProductExample;
 
 /**
  * Comparator for ProductExample
- * @param a ProductExample*
- * @param b ProductExample*
+ * @param a the link of a ProductExample
+ * @param b the link of a ProductExample
  * @return -1 if a<b, 0 if a==b, 1 if b<a
  */
-int productComparatorByName(const void *a, const void *b)
+int productComparatorByName(const RBLink *a, const RBLink *b)
 {
-	ProductExample *first = (ProductExample *) a;
-	ProductExample *second = (ProductExample *) b;
+	ProductExample *first = RB_CONTAINER_OF(a, ProductExample, link);
+	ProductExample *second = RB_CONTAINER_OF(b, ProductExample, link);
 	double diff = strcmp(first->name, second->name);
 	if (diff < 0)
 	{
@@ -45,26 +46,34 @@ int productComparatorByName(const void *a, const void *b)
 	}
 }
 
-void productFree(void *a)
+void productFree(ProductExample *pProduct)
 {
-	ProductExample *pProduct = (ProductExample *) a;
 	free(pProduct->name);
-	free(a);
+	free(pProduct);
+}
+
+/**
+ * frees the product of a link
+ * @param link the link of a ProductExample
+ */
+void productLinkFree(RBLink *link)
+{
+	productFree(RB_CONTAINER_OF(link, ProductExample, link));
 }
 
 /**
  *
- * @param pProduct pointer to product to print
+ * @param link the link of the product to print
  * @param null required argument for typedef
  * @return
  */
-int printProduct(const void *pProduct, void *null)
+int printProduct(const RBLink *link, void *null)
 {
 	if (null != NULL)
 	{
 		return 0;
 	}
-	ProductExample *product = (ProductExample *) pProduct;
+	ProductExample *product = RB_CONTAINER_OF(link, ProductExample, link);
 	printf("Name: %s.\t\tPrice: %.2f\n", product->name, product->price);
 
 	return 1;
@@ -116,9 +125,9 @@ ProductExample **getProducts()
 
 }
 
-void freeResources(RBTree **tree, ProductExample ***products)
+void freeResources(IntrusiveRBTree **tree, ProductExample ***products)
 {
-	freeRBTree(tree);
+	freeIntrusiveRBTree(tree);
 	productFree((*products)[1]);
 	productFree((*products)[5]);
 	free(*products);
@@ -137,17 +146,17 @@ int main()
 {
     ProductExample **products = getProducts();
 
-    RBTree *tree = newRBTree(productComparatorByName, productFree);
+    IntrusiveRBTree *tree = newIntrusiveRBTree(productComparatorByName, productLinkFree);
 
-    insertToRBTree(tree, products[2]);
-	insertToRBTree(tree, products[3]);
-	insertToRBTree(tree, products[4]);
-	insertToRBTree(tree, products[0]);
+    insertToIntrusiveRBTree(tree, &products[2]->link);
+	insertToIntrusiveRBTree(tree, &products[3]->link);
+	insertToIntrusiveRBTree(tree, &products[4]->link);
+	insertToIntrusiveRBTree(tree, &products[0]->link);
 
     int i = 0;
 	for (i = 0; i < 6; i++)
 	{
-		if (RBTreeContains(tree, products[i]))
+		if (intrusiveRBTreeContains(tree, &products[i]->link))
 		{
 			printf("\"%s\" is in the tree.\n", products[i]->name);
 			if (i == 1 || i == 5)
@@ -170,7 +179,7 @@ int main()
 	}
 
 	printf("\nThe number of products in the tree is %lu.\n\n", tree->size);
-	forEachRBTree(tree, printProduct, NULL);
+	forEachIntrusiveRBTree(tree, printProduct, NULL);
 	freeResources(&tree, &products);
 	printf("test passed\n");
 	return 0;
@@ -6,32 +6,36 @@
  * @brief This file implements a generic Red-Black Tree DS
  *
  * @section DESCRIPTION
- * Node struct members : left, right, parent, data, color
- * RBTree struct members: root, size, compare function,
- * RBTree supported operations : building, insertion, deletion, contains, forEach, free memory
+ * Node struct members : left, right, parent, data, color, dead flag (interval trees: IntervalNode, with endpoints)
+ * RBTree struct members: root, size, compare function, last insertion point (finger),
+ * RBTree supported operations : building, insertion, deletion, contains, forEach, free memory,
+ * handle based lookup, deletion and update, hinted insertion, interval overlap queries,
+ * operations log (a LogFunc hook, see RBTreeLog.c), lazy deletion and compaction, memory accounting
  */
 
 #include <stdlib.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 #include "RBTree.h"
 
 #define SUCCESS 1
 #define FAILURE 0
 
-// ------------------------------ Functions -----------------------------
-
-// ---------------- Utilities ----------------
-
 /**
- * Switch between two nodes values
- * @param a: first node
- * @param b: second node
+ * a node of an interval tree - a Node, followed by the endpoints which only interval trees need
  */
-static void switchValues(Node *a, Node *b)
+typedef struct IntervalNode
 {
-    void *temp = a->data;
-    a->data = b->data;
-    b->data = temp;
-}
+    Node node;
+    double high, maxHigh; // the node's high endpoint, and the maximal one in its subtree.
+} IntervalNode;
+
+#define INTERVAL(n) ((IntervalNode *)(n))
+
+// ------------------------------ Functions -----------------------------
+
+// ---------------- Utilities ----------------
 
 /**
  *  Finds if n is a left child or right child
@@ -108,6 +112,109 @@ static Node * successor(Node *x)
     return s;
 }
 
+/**
+ * Switch the positions (and colors) of a node and its successor in the tree, without moving their values,
+ * so handles to both nodes stay valid
+ * @param tree: the tree
+ * @param m: a node with two children
+ * @param s: m's successor
+ */
+static void switchWithSuccessor(RBTree *tree, Node *m, Node *s)
+{
+    Node *mParent = m->parent, *mLeft = m->left, *mRight = m->right;
+    Node *sParent = s->parent, *sRight = s->right;
+    Node **ptrToM = findPtrToChild(m);
+
+    Color tempColor = m->color;
+    m->color = s->color;
+    s->color = tempColor;
+
+    // s takes m's place
+    if (ptrToM == NULL)
+    {
+        tree->root = s;
+    }
+    else
+    {
+        *ptrToM = s;
+    }
+    s->parent = mParent;
+    s->left = mLeft;
+    mLeft->parent = s;
+    if (sParent == m)
+    {
+        s->right = m;
+        m->parent = s;
+    }
+    else
+    {
+        s->right = mRight;
+        mRight->parent = s;
+        sParent->left = m;
+        m->parent = sParent;
+    }
+
+    // m takes s's place (the successor has no left child)
+    m->left = NULL;
+    m->right = sRight;
+    if (sRight != NULL)
+    {
+        sRight->parent = m;
+    }
+}
+
+/**
+ * Finds the size of the nodes of a tree
+ * @param tree: the tree
+ * @return: sizeof(IntervalNode) for an interval tree, sizeof(Node) otherwise
+ */
+static size_t nodeSize(const RBTree *tree)
+{
+    return (tree->highFunc != NULL) ? sizeof(IntervalNode) : sizeof(Node);
+}
+
+/**
+ * Recomputes the maximal high endpoint in the subtree of a given node (does nothing if the tree is not an
+ * interval tree)
+ * @param tree: the tree
+ * @param n: a node whose children are up to date
+ */
+static void updateMaxHigh(const RBTree *tree, Node *n)
+{
+    if (tree->highFunc == NULL)
+    {
+        return;
+    }
+    double maxHigh = INTERVAL(n)->high;
+    if (n->left != NULL && INTERVAL(n->left)->maxHigh > maxHigh)
+    {
+        maxHigh = INTERVAL(n->left)->maxHigh;
+    }
+    if (n->right != NULL && INTERVAL(n->right)->maxHigh > maxHigh)
+    {
+        maxHigh = INTERVAL(n->right)->maxHigh;
+    }
+    INTERVAL(n)->maxHigh = maxHigh;
+}
+
+/**
+ * Recomputes the maximal high endpoint of a given node and all of its ancestors (does nothing if the tree is
+ * not an interval tree)
+ * @param tree: the tree
+ * @param n: a node (may be NULL)
+ */
+static void updateMaxHighPath(const RBTree *tree, Node *n)
+{
+    if (tree->highFunc == NULL)
+    {
+        return;
+    }
+    for (; n != NULL; n = n->parent)
+    {
+        updateMaxHigh(tree, n);
+    }
+}
+
 /**
  * search a given data in a given RBTree
  * @param root: the root of a given tree
@@ -160,7 +267,8 @@ static int inOrder(Node *root, forEachFunc func, void *args)
         }
     }
 
-    success = func(root->data, args);
+    // deleted (lazily) nodes are skipped
+    success = root->dead || func(root->data, args);
     if (!success)
     {
         // function activation failure
@@ -175,6 +283,39 @@ static int inOrder(Node *root, forEachFunc func, void *args)
     return success;
 }
 
+/**
+ * Traversing the nodes of an interval tree In-Order, and activates a given function on each node whose interval
+ * overlaps a given range. subtrees which end before the range, or start after it, are skipped.
+ * @param tree: the interval tree
+ * @param root: the root of a given subtree
+ * @param low, high: the range
+ * @param func: a function to call on each overlapping node
+ * @param args: an argument to pass to 'func'
+ * @return: FAILURE if the given function with args input returns an error, SUCCESS otherwise.
+ */
+static int inOrderOverlapping(const RBTree *tree, Node *root, double low, double high, forEachFunc func,
+                              void *args)
+{
+    if (root == NULL || INTERVAL(root)->maxHigh < low)
+    {
+        return SUCCESS;
+    }
+    if (!inOrderOverlapping(tree, root->left, low, high, func, args))
+    {
+        return FAILURE;
+    }
+    if (tree->lowFunc(root->data) > high)
+    {
+        // root and its right subtree start after the range
+        return SUCCESS;
+    }
+    if (!root->dead && INTERVAL(root)->high >= low && !func(root->data, args))
+    {
+        return FAILURE;
+    }
+    return inOrderOverlapping(tree, root->right, low, high, func, args);
+}
+
 /**
  * De-allocated memory of a single node in a tree
  */
@@ -206,13 +347,102 @@ static void freeAllNodes(Node * root, FreeFunc freeFunc)
     free(root);
 }
 
+// ---------------- Memory ----------------
+
+/**
+ * Finds the number of bytes the allocator holds for an allocation (the requested size, its header and padding)
+ * @param ptr: the allocated memory
+ * @param requested: the requested size of the allocation
+ * @return: the size of the allocation
+ */
+static size_t allocationSize(const void *ptr, size_t requested)
+{
+#ifdef __GLIBC__
+    (void)requested;
+    return malloc_usable_size((void *)ptr) + sizeof(size_t);
+#else
+    // an estimate - a size header, rounded up to the usual malloc alignment
+    (void)ptr;
+    size_t alignment = 2 * sizeof(void *);
+    return (requested + sizeof(size_t) + alignment - 1) / alignment * alignment;
+#endif
+}
+
+/**
+ * Adds the memory of the nodes of a given tree to a memory footprint
+ * @param root: the root of a given tree
+ * @param size: the size of a node
+ * @param sizeFunc: the item size function (may be NULL)
+ * @param usage: the memory footprint to add to
+ */
+static void measureNodes(const Node *root, size_t size, SizeFunc sizeFunc, RBTreeMemory *usage)
+{
+    if (root == NULL)
+    {
+        return;
+    }
+    usage->nodeCount += 1;
+    usage->nodeBytes += size;
+    usage->slackBytes += allocationSize(root, size) - size;
+    if (sizeFunc != NULL)
+    {
+        usage->payloadBytes += sizeFunc(root->data);
+    }
+    measureNodes(root->left, size, sizeFunc, usage);
+    measureNodes(root->right, size, sizeFunc, usage);
+}
+
+/**
+ * Updates the running memory total of a tree when a node is added or removed
+ * @param tree: the tree
+ * @param n: the added (or removed) node, with its data
+ * @param added: 1 if the node was added, 0 if it is being removed
+ */
+static void trackNode(RBTree *tree, const Node *n, int added)
+{
+    if (tree->sizeFunc == NULL)
+    {
+        return;
+    }
+    size_t bytes = allocationSize(n, nodeSize(tree)) + tree->sizeFunc(n->data);
+    tree->memoryUsage = added ? tree->memoryUsage + bytes : tree->memoryUsage - bytes;
+}
+
+/**
+ * Updates the running memory total of a tree when the data of a node is replaced
+ * @param tree: the tree
+ * @param oldData: the replaced data
+ * @param newData: the new data
+ */
+static void trackData(RBTree *tree, const void *oldData, const void *newData)
+{
+    if (tree->sizeFunc == NULL)
+    {
+        return;
+    }
+    tree->memoryUsage = tree->memoryUsage - tree->sizeFunc(oldData) + tree->sizeFunc(newData);
+}
+
+/**
+ * Records an operation in the log of a tree (if it has one), before the operation is applied
+ * @param tree: the tree
+ * @param op: the operation code
+ * @param data: the item of the operation
+ * @return: FAILURE if the tree has a log and the operation cannot be recorded, SUCCESS otherwise
+ */
+static int logOperation(const RBTree *tree, char op, const void *data)
+{
+    return tree->logFunc == NULL || tree->logFunc(tree->log, op, data);
+}
+
 // ---------------- Insertion ----------------
 
 /**
  * Performs left rotation on node 'n'
+ * @param tree: the tree
  * @param n: a node
  */
-static void leftRotation(Node *n)
+static void leftRotation(const RBTree *tree, Node *n)
 {
     Node *parent = n->parent;
     Node *rightChild = n->right;
@@ -239,13 +469,16 @@ static void leftRotation(Node *n)
             parent->right = rightChild;
         }
     }
+    updateMaxHigh(tree, n);
+    updateMaxHigh(tree, rightChild);
 }
 
 /**
  * Performs right rotation on node 'n'
+ * @param tree: the tree
  * @param n: a node
  */
-static void rightRotation(Node *n)
+static void rightRotation(const RBTree *tree, Node *n)
 {
     Node *parent = n->parent; 
     Node *leftChild = n->left; 
@@ -272,15 +505,17 @@ static void rightRotation(Node *n)
             parent->right = leftChild;
         }
     }
-
+    updateMaxHigh(tree, n);
+    updateMaxHigh(tree, leftChild);
 }
 
 /**
  * Rotates the parent of a given node in order to create a chain of nodes
+ * @param tree: the tree
  * @param n: a given node
  * @return: 1 if changes were made, 0 otherwise
  */
-static int chain(Node *n)
+static int chain(const RBTree *tree, Node *n)
 {
     Node *p = n->parent;
     if (p == NULL || p->parent == NULL)
@@ -291,13 +526,13 @@ static int chain(Node *n)
 
     if (g->left != NULL && g->left->right == n)
     {
-        leftRotation(p);
+        leftRotation(tree, p);
         return 1;
     }
 
     if (g->right != NULL && g->right->left == n)
     {
-        rightRotation(p);
+        rightRotation(tree, p);
         return 1;
     }
     return 0;
@@ -306,9 +541,10 @@ static int chain(Node *n)
 
 /**
  * Repair the tree structure (colors, rotations) after insertion
+ * @param tree: the tree
  * @param n: the newest node in the tree
  */
-static void repairRBTree(Node *n)
+static void repairRBTree(const RBTree *tree, Node *n)
 {
     if (n->parent == NULL)
     {
@@ -338,12 +574,12 @@ static void repairRBTree(Node *n)
         p->color = BLACK;
         u->color = BLACK;
         g->color = RED;
-        repairRBTree(g);
+        repairRBTree(tree, g);
         return;
     }
 
     // case 4a
-    int swap = chain(n);
+    int swap = chain(tree, n);
     if (swap)
     {
         Node *tmp = p;
@@ -354,57 +590,168 @@ static void repairRBTree(Node *n)
     // case 4b
     if (g->left != NULL && g->left->left == n)
     {
-        rightRotation(g);
+        rightRotation(tree, g);
     }
     if (g->right != NULL && g->right->right == n)
     {
 
-        leftRotation(g);
+        leftRotation(tree, g);
     }
     // case 4c
     p->color = BLACK;
     g->color = RED;
 }
 
+/**
+ * Allocates a new (red, unlinked) node which stores a given data
+ * @param tree: the tree of the node (an interval tree allocates an IntervalNode)
+ * @param data: the data of the node
+ * @return: the new node, NULL on memory allocation failure
+ */
+static Node * createNode(const RBTree *tree, void *data)
+{
+    Node *newNode = (Node*)malloc(nodeSize(tree));
+    if (newNode == NULL)
+    {
+        return NULL;
+    }
+    newNode->data = data;
+    newNode->color = RED;
+    newNode->dead = 0;
+    newNode->left = NULL;
+    newNode->right = NULL;
+    newNode->parent = NULL;
+    if (tree->highFunc != NULL)
+    {
+        INTERVAL(newNode)->high = 0;
+        INTERVAL(newNode)->maxHigh = 0;
+    }
+    return newNode;
+}
+
+/**
+ * Climbs from a hint node up to the node whose subtree should contain a given data, i.e. the lowest ancestor
+ * which is smaller (bigger) than the data while the data is smaller (bigger) than its nearest ancestor from
+ * the other side. climbing over nodes which are known to be on the same side of the data costs no comparison.
+ * @param hint: a node of the tree
+ * @param data: the data for insertion
+ * @param compFunc : comparison function
+ * @param equal: output - the node which is equal to the data, if the tree already contains it
+ * @return: the node to descend from, NULL if the tree already contains the given data
+ */
+static Node * climbFromHint(Node *hint, const void *data, CompareFunc compFunc, Node **equal)
+{
+    int diff = compFunc(data, hint->data);
+    if (diff == 0)
+    {
+        *equal = hint;
+        return NULL;
+    }
+
+    Node *n = hint;
+    while (1)
+    {
+        // find the nearest ancestor on the other side of the data (the bound of n's subtree)
+        Node *a = n;
+        while (a->parent != NULL && ((diff > 0) ? a->parent->right : a->parent->left) == a)
+        {
+            a = a->parent;
+        }
+        Node *bound = a->parent;
+        if (bound == NULL)
+        {
+            // n's subtree is unbounded from the data's side
+            return n;
+        }
+
+        int boundDiff = compFunc(data, bound->data);
+        if (boundDiff == 0)
+        {
+            *equal = bound;
+            return NULL;
+        }
+        if ((boundDiff > 0) != (diff > 0))
+        {
+            // the data is between n and its bound
+            return n;
+        }
+        n = bound;
+    }
+}
+
+/**
+ * Inserts a given data to the subtree of a given node
+ * @param tree: the tree (its comparison function and node type)
+ * @param start: a node whose subtree should contain the data
+ * @param data: the data for insertion
+ * @param equal: output - the node which is equal to the data, if the tree already contains it
+ * @return: a pointer to the new node which stores the given data, NULL if the data is already in the tree
+ */
+static Node * insertBelow(const RBTree *tree, Node *start, void *data, Node **equal)
+{
+    Node *parent = start;
+    Node **position = NULL;
+    while (1)
+    {
+        int diff = tree->compFunc(data, parent->data);
+        if (diff == 0)
+        {
+            // the tree already contains the given data
+            *equal = parent;
+            return NULL;
+        }
+        position = (diff > 0) ? &(parent->right) : &(parent->left);
+        if (*position == NULL)
+        {
+            break;
+        }
+        parent = *position;
+    }
+
+    Node *newNode = createNode(tree, data);
+    if (newNode != NULL)
+    {
+        newNode->parent = parent;
+        *position = newNode;
+    }
+    return newNode;
+}
+
 /**
  * Inserts a given data to a given tree
- * @param root: a pointer to the root of the tree
+ * @param tree: the tree (its comparison function and node type)
+ * @param root: a pointer to the root of the (sub)tree
  * @param data: the data for insertion
- * @param compFunc : comparison function to compare between two node's data
+ * @param equal: output - the node which is equal to the data, if the tree already contains it
  * @return: a pointer to the new node which stores the given data
  */
-static Node * insertValue(Node **root, void *data, CompareFunc compFunc)
+static Node * insertValue(const RBTree *tree, Node **root, void *data, Node **equal)
 {
     Node *newNode = NULL;
     if (*root == NULL)
     {
-        // initialize a new node with the data
-        newNode = (Node*)malloc(sizeof(Node));
-        newNode->data = data;
-        newNode->color = RED;
-        newNode->left = NULL;
-        newNode->right = NULL;
-        newNode->parent = NULL;
+        newNode = createNode(tree, data);
         *root = newNode;
         return newNode;
     }
     else
     {
-        int diff = compFunc(data, (*root)->data);
+        int diff = tree->compFunc(data, (*root)->data);
         if (diff == 0)
         {
             // the tree already contains the given data
+            *equal = *root;
             return NULL;
         }
         else if (diff > 0)
         {
             // the data is "bigger" then the current node's data
-            newNode = insertValue(&((*root)->right), data, compFunc);
+            newNode = insertValue(tree, &((*root)->right), data, equal);
         }
         else
         {
             // the data is "smaller" then the current node's data
-            newNode = insertValue(&((*root)->left), data, compFunc);
+            newNode = insertValue(tree, &((*root)->left), data, equal);
         }
         if (newNode != NULL && newNode->parent == NULL)
         {
@@ -418,10 +765,11 @@ static Node * insertValue(Node **root, void *data, CompareFunc compFunc)
 
 /**
  * Fix the tree structure (colors and rotations) after node deletion
+ * @param tree: the tree
  * @param p: the parent of the deleted node m
  * @param s: the sibling of the deleted node m
  */
-static void fixTreeStructure(Node *p, Node *s)
+static void fixTreeStructure(const RBTree *tree, Node *p, Node *s)
 {
 
     // ----------case 3a--------------
@@ -444,7 +792,7 @@ static void fixTreeStructure(Node *p, Node *s)
         else
         {
             s->color = RED;
-            fixTreeStructure(p->parent, findSibling(p));
+            fixTreeStructure(tree, p->parent, findSibling(p));
         }
     }
     else
@@ -456,13 +804,13 @@ static void fixTreeStructure(Node *p, Node *s)
             p->color = RED;
             if (p->left != s)
             {
-                leftRotation(p);
-                fixTreeStructure(p, p->right);
+                leftRotation(tree, p);
+                fixTreeStructure(tree, p, p->right);
             }
             else
             {
-                rightRotation(p);
-                fixTreeStructure(p, p->left);
+                rightRotation(tree, p);
+                fixTreeStructure(tree, p, p->left);
             }
         }
         else
@@ -481,13 +829,13 @@ static void fixTreeStructure(Node *p, Node *s)
                 s->color = RED;
                 if (p->left != s)
                 {
-                    rightRotation(s);
+                    rightRotation(tree, s);
                 }
                 else
                 {
-                    leftRotation(s);
+                    leftRotation(tree, s);
                 }
-                fixTreeStructure(p, sc);
+                fixTreeStructure(tree, p, sc);
                 return;
             }
             // ----------case 3e--------------
@@ -498,11 +846,11 @@ static void fixTreeStructure(Node *p, Node *s)
                 p->color = tempColor;
                 if (p->left != s)
                 {
-                    leftRotation(p);
+                    leftRotation(tree, p);
                 }
                 else
                 {
-                    rightRotation(p);
+                    rightRotation(tree, p);
                 }
                 sf->color = BLACK;
             }
@@ -521,22 +869,32 @@ static void fixTreeStructure(Node *p, Node *s)
 static void deleteNode(RBTree *tree, Node *m, Node *p, Node *s, Node *c)
 {
     Node ** ptrToM = findPtrToChild(m);
-    Node ** ptrToC = findPtrToChild(c);
 
     // ----------case 1--------------
     if (m->color == RED)
     {
         *ptrToM = NULL;
         freeNode(m, tree->freeFunc);
+        updateMaxHighPath(tree, p);
         return;
     }
 
     // ----------case 2--------------
     if (c != NULL && c->color == RED)
     {
-        *ptrToC = NULL;
-        switchValues(m, c);
-        freeNode(c, tree->freeFunc);
+        // c takes m's place (instead of switching values) so handles to c stay valid
+        if (ptrToM == NULL)
+        {
+            tree->root = c;
+        }
+        else
+        {
+            *ptrToM = c;
+        }
+        c->parent = p;
+        c->color = BLACK;
+        freeNode(m, tree->freeFunc);
+        updateMaxHighPath(tree, p);
     }
 
     // ----------case 3--------------
@@ -551,33 +909,190 @@ static void deleteNode(RBTree *tree, Node *m, Node *p, Node *s, Node *c)
         {
             *ptrToM = NULL;
             freeNode(m, tree->freeFunc);
-            fixTreeStructure(p, s);
+            // the rotations of the fix keep the endpoints up to date, given that the path is up to date
+            updateMaxHighPath(tree, p);
+            fixTreeStructure(tree, p, s);
+        }
+    }
+}
+
+/**
+ * Completes an insertion of a new node - repairs the tree and updates its members
+ * @param tree: the tree
+ * @param newNode: the new node (NULL if the insertion failed)
+ * @param handle: output - the new node (may be NULL)
+ * @return: FAILURE if the insertion failed, SUCCESS otherwise
+ */
+static int completeInsertion(RBTree *tree, Node *newNode, Node **handle)
+{
+    if (newNode == NULL)
+    {
+        return FAILURE;
+    }
+    if (!logOperation(tree, RB_LOG_INSERT, newNode->data))
+    {
+        // the insertion cannot be logged - the new node is still an unrepaired leaf, so it is simply unlinked
+        Node **ptrToNew = findPtrToChild(newNode);
+        if (ptrToNew == NULL)
+        {
+            tree->root = NULL;
         }
+        else
+        {
+            *ptrToNew = NULL;
+        }
+        free(newNode);
+        return FAILURE;
+    }
+    tree->size += 1;
+    trackNode(tree, newNode, 1);
+
+    if (tree->highFunc != NULL)
+    {
+        INTERVAL(newNode)->high = tree->highFunc(newNode->data);
+        updateMaxHighPath(tree, newNode);
     }
+    // Repair the tree
+    repairRBTree(tree, newNode);
+    // Update root pointer if needed
+    while (tree->root != NULL && tree->root->parent != NULL)
+    {
+        tree->root = tree->root->parent;
+    }
+    tree->finger = newNode;
+    if (handle != NULL)
+    {
+        *handle = newNode;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Stores a given data in a lazily deleted node which is equal to it, instead of inserting a new node
+ * @param tree: the tree
+ * @param n: a dead node which is equal to data
+ * @param data: the inserted data
+ * @param handle: output - the revived node (may be NULL)
+ * @return: FAILURE if the insertion cannot be logged, SUCCESS otherwise
+ */
+static int reviveNode(RBTree *tree, Node *n, void *data, Node **handle)
+{
+    if (!logOperation(tree, RB_LOG_INSERT, data))
+    {
+        return FAILURE;
+    }
+    trackData(tree, n->data, data);
+    tree->freeFunc(n->data);
+    n->data = data;
+    n->dead = 0;
+    tree->deadCount -= 1;
+    tree->size += 1;
+    if (tree->highFunc != NULL)
+    {
+        INTERVAL(n)->high = tree->highFunc(data);
+        updateMaxHighPath(tree, n);
+    }
+    tree->finger = n;
+    if (handle != NULL)
+    {
+        *handle = n;
+    }
+    return SUCCESS;
+}
+
+// ---------------- Compaction ----------------
+
+/**
+ * Collects the nodes of a tree In-Order
+ * @param root: the root of a given tree
+ * @param nodes: the array to collect into
+ * @param next: the index of the next node to collect
+ * @return: the index of the next node to collect after the subtree of root
+ */
+static long unsigned collectNodes(Node *root, Node **nodes, long unsigned next)
+{
+    if (root == NULL)
+    {
+        return next;
+    }
+    next = collectNodes(root->left, nodes, next);
+    nodes[next++] = root;
+    return collectNodes(root->right, nodes, next);
+}
+
+/**
+ * Links sorted nodes into a balanced tree. all the levels are full except (maybe) the deepest one, whose nodes
+ * are colored red - so every path has the same number of black nodes
+ * @param tree: the tree of the nodes
+ * @param nodes: the sorted nodes
+ * @param first, last: the range of nodes to link (inclusive)
+ * @param parent: the parent of the subtree
+ * @param depth: the depth of the subtree root
+ * @param redDepth: the depth of the red nodes (-1 if all nodes are black)
+ * @return: the root of the subtree
+ */
+static Node * linkBalanced(const RBTree *tree, Node **nodes, long first, long last, Node *parent, int depth,
+                           int redDepth)
+{
+    if (first > last)
+    {
+        return NULL;
+    }
+    long mid = first + (last - first) / 2;
+    Node *n = nodes[mid];
+    n->parent = parent;
+    n->color = (depth == redDepth) ? RED : BLACK;
+    n->left = linkBalanced(tree, nodes, first, mid - 1, n, depth + 1, redDepth);
+    n->right = linkBalanced(tree, nodes, mid + 1, last, n, depth + 1, redDepth);
+    updateMaxHigh(tree, n);
+    return n;
 }
 
 // ---------------- Header ----------------
 
 /**
- * remove an item from the tree
+ * remove the item stored in a given node from the tree, without searching for it.
  * @param tree: the tree to remove an item from.
- * @param data: item to remove from the tree.
- * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ * @param handle: a node of the tree (as returned by RBTreeFind or insertToRBTreeWithHandle).
+ * @return: 0 on failure, other on success.
  */
-int deleteFromRBTree(RBTree *tree, void *data)
+int deleteRBTreeNode(RBTree *tree, Node *handle)
 {
-    Node *m = search(tree->root, data, tree->compFunc);
-    if (m == NULL)
+    if (tree == NULL || handle == NULL)
+    {
+        return FAILURE;
+    }
+    Node *m = handle;
+    if (m->dead)
     {
         return FAILURE;
     }
+    if (!logOperation(tree, RB_LOG_DELETE, m->data))
+    {
+        return FAILURE;
+    }
+    if (tree->maxDeadRatio > 0)
+    {
+        // lazy deletion - the node stays in the tree (with its data, for the comparisons) until compaction
+        m->dead = 1;
+        tree->size -= 1;
+        tree->deadCount += 1;
+        if (tree->deadCount > tree->maxDeadRatio * (double)(tree->size + tree->deadCount))
+        {
+            compactRBTree(tree);
+        }
+        return SUCCESS;
+    }
+    if (tree->finger == m)
+    {
+        tree->finger = NULL;
+    }
     if (m->left != NULL && m->right != NULL)
     {
-        Node *s = successor(m);
-        switchValues(m, s);
-        m = s;
+        switchWithSuccessor(tree, m, successor(m));
     }
 
+    trackNode(tree, m, 0);
     Node *p = m->parent;
     Node *s = findSibling(m);
     Node *c = findChild(m);
@@ -592,6 +1107,58 @@ int deleteFromRBTree(RBTree *tree, void *data)
     return SUCCESS;
 }
 
+/**
+ * remove an item from the tree
+ * @param tree: the tree to remove an item from.
+ * @param data: item to remove from the tree.
+ * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ */
+int deleteFromRBTree(RBTree *tree, void *data)
+{
+    Node *m = RBTreeFind(tree, data);
+    if (m == NULL)
+    {
+        return FAILURE;
+    }
+    return deleteRBTreeNode(tree, m);
+}
+
+/**
+ * replace the item stored in a given node with an equal item (by the tree's CompareFunc), without searching
+ * for it. the old item is freed.
+ * @param tree: the tree which contains the node.
+ * @param handle: a node of the tree.
+ * @param newData: the new item, must be equal to the current item of the node.
+ * @return: 0 on failure, other on success. (if newData is not equal to the current item - failure).
+ */
+int RBTreeReplaceData(RBTree *tree, Node *handle, void *newData)
+{
+    if (tree == NULL || handle == NULL || newData == NULL || handle->dead)
+    {
+        return FAILURE;
+    }
+    if (tree->compFunc(newData, handle->data) != 0)
+    {
+        return FAILURE;
+    }
+    if (!logOperation(tree, RB_LOG_UPDATE, newData))
+    {
+        return FAILURE;
+    }
+    if (newData != handle->data)
+    {
+        trackData(tree, handle->data, newData);
+        tree->freeFunc(handle->data);
+        handle->data = newData;
+    }
+    if (tree->highFunc != NULL)
+    {
+        INTERVAL(handle)->high = tree->highFunc(newData);
+        updateMaxHighPath(tree, handle);
+    }
+    return SUCCESS;
+}
+
 /**
  * add an item to the tree
  * @param tree: the tree to add an item to.
@@ -599,28 +1166,85 @@ int deleteFromRBTree(RBTree *tree, void *data)
  * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
  */
 int insertToRBTree(RBTree *tree, void *data)
+{
+    return insertToRBTreeWithHandle(tree, data, NULL);
+}
+
+/**
+ * add an item to the tree, and get a handle to the node which stores it.
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @param handle: output - the node which stores data (may be NULL). valid until the item is deleted.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToRBTreeWithHandle(RBTree *tree, void *data, Node **handle)
 {
     if (tree == NULL || data == NULL)
     {
         return FAILURE;
     }
     // Insert to tree
-    Node *newNode = insertValue(&(tree->root), data, tree->compFunc);
+    Node *equal = NULL;
+    Node *newNode = insertValue(tree, &(tree->root), data, &equal);
+    if (equal != NULL && equal->dead)
+    {
+        return reviveNode(tree, equal, data, handle);
+    }
+    return completeInsertion(tree, newNode, handle);
+}
 
-    if (newNode == NULL)
+/**
+ * add an item to the tree, searching for its position upwards from a hint node and then down, instead of from
+ * the root. for (nearly) sorted input the hint should be the node of the previous item, which makes the insertion
+ * cost amortized O(1) comparisons.
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @param hint: a node of the tree, NULL for the tree's last insertion point.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int insertToRBTreeHint(RBTree *tree, void *data, Node *hint)
+{
+    if (tree == NULL || data == NULL)
     {
         return FAILURE;
     }
-    tree->size += 1;
+    if (hint == NULL)
+    {
+        hint = (tree->finger != NULL) ? tree->finger : tree->root;
+    }
+    if (hint == NULL)
+    {
+        return insertToRBTree(tree, data);
+    }
 
-    // Repair the tree
-    repairRBTree(newNode);
-    // Update root pointer if needed
-    while (tree->root != NULL && tree->root->parent != NULL)
+    Node *equal = NULL;
+    Node *newNode = NULL;
+    Node *start = climbFromHint(hint, data, tree->compFunc, &equal);
+    if (start != NULL)
     {
-        tree->root = tree->root->parent;
+        newNode = insertBelow(tree, start, data, &equal);
     }
-    return SUCCESS;
+    if (equal != NULL && equal->dead)
+    {
+        return reviveNode(tree, equal, data, NULL);
+    }
+    return completeInsertion(tree, newNode, NULL);
+}
+
+/**
+ * find the node which stores an item.
+ * @param tree: RBTree
+ * @param data: item to search for.
+ * @return: the node of the item (a handle, valid until the item is deleted), NULL if it is not in the tree.
+ */
+Node *RBTreeFind(const RBTree *tree, const void *data)
+{
+    if (tree == NULL || data == NULL)
+    {
+        return NULL;
+    }
+    Node *n = search(tree->root, data, tree->compFunc);
+    return (n != NULL && !n->dead) ? n : NULL;
 }
 
 /**
@@ -631,7 +1255,7 @@ int insertToRBTree(RBTree *tree, void *data)
  */
 int RBTreeContains(const RBTree *tree, const void *data)
 {
-    if (search(tree->root, data, tree->compFunc))
+    if (RBTreeFind(tree, data))
     {
         // RBTree contains the item
         return SUCCESS;
@@ -653,6 +1277,139 @@ int forEachRBTree(const RBTree *tree, forEachFunc func, void *args)
     return inOrder(tree->root, func, args);
 }
 
+/**
+ * Activate a function on each item of an interval tree which overlaps the closed range [low, high], in an
+ * ascending order. if one of the activations of the function returns 0, the process stops.
+ * @param tree: an interval tree (see newIntervalRBTree).
+ * @param low, high: the range.
+ * @param func: the function to activate on the overlapping items.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success. (if the tree is not an interval tree - failure).
+ */
+int forEachOverlappingRBTree(const RBTree *tree, double low, double high, forEachFunc func, void *args)
+{
+    if (tree == NULL || tree->lowFunc == NULL || tree->highFunc == NULL)
+    {
+        return FAILURE;
+    }
+    return inOrderOverlapping(tree, tree->root, low, high, func, args);
+}
+
+/**
+ * remove the lazily deleted nodes from the tree, by rebuilding it in a single linear pass.
+ * @param tree: the tree to compact.
+ * @return: 0 on failure, other on success.
+ */
+int compactRBTree(RBTree *tree)
+{
+    if (tree == NULL)
+    {
+        return FAILURE;
+    }
+    if (tree->deadCount == 0)
+    {
+        return SUCCESS;
+    }
+    Node **nodes = (Node **)malloc(sizeof(Node *) * (tree->size + tree->deadCount));
+    if (nodes == NULL)
+    {
+        return FAILURE;
+    }
+    long unsigned count = collectNodes(tree->root, nodes, 0);
+
+    // release the dead nodes, and keep the live ones (which stay valid handles) in order
+    long unsigned live = 0;
+    for (long unsigned i = 0; i < count; ++i)
+    {
+        if (nodes[i]->dead)
+        {
+            if (tree->finger == nodes[i])
+            {
+                tree->finger = NULL;
+            }
+            trackNode(tree, nodes[i], 0);
+            freeNode(nodes[i], tree->freeFunc);
+        }
+        else
+        {
+            nodes[live++] = nodes[i];
+        }
+    }
+
+    // the deepest level is full iff live + 1 is a power of 2
+    int redDepth = -1;
+    if (((live + 1) & live) != 0)
+    {
+        redDepth = 0;
+        while ((live >> (redDepth + 1)) != 0)
+        {
+            redDepth++;
+        }
+    }
+    tree->root = linkBalanced(tree, nodes, 0, (long)live - 1, NULL, 0, redDepth);
+    tree->deadCount = 0;
+    free(nodes);
+    return SUCCESS;
+}
+
+/**
+ * set the deletion mode of the tree. in lazy mode, a deletion only marks the node as dead (so it is skipped by
+ * searches and iterations), and the tree is compacted once the dead nodes pass a given ratio of its nodes.
+ * @param tree: the tree.
+ * @param maxDeadRatio: the ratio of dead nodes which triggers compaction, 0 for eager deletion.
+ * @return: 0 on failure, other on success.
+ */
+int setRBTreeLazyDeletion(RBTree *tree, double maxDeadRatio)
+{
+    if (tree == NULL || maxDeadRatio < 0 || maxDeadRatio >= 1)
+    {
+        return FAILURE;
+    }
+    tree->maxDeadRatio = maxDeadRatio;
+    if (maxDeadRatio == 0)
+    {
+        return compactRBTree(tree);
+    }
+    return SUCCESS;
+}
+
+/**
+ * measure the memory footprint of the tree, by visiting all of its nodes.
+ * @param tree: the tree.
+ * @param sizeFunc: a function which returns the size of an item (NULL - the items are not counted).
+ * @return: the memory footprint (all zero if tree is NULL).
+ */
+RBTreeMemory RBTreeMemoryUsage(const RBTree *tree, SizeFunc sizeFunc)
+{
+    RBTreeMemory usage = {0, 0, 0, 0, 0, 0};
+    if (tree == NULL)
+    {
+        return usage;
+    }
+    usage.treeBytes = sizeof(RBTree);
+    usage.slackBytes = allocationSize(tree, sizeof(RBTree)) - sizeof(RBTree);
+    measureNodes(tree->root, nodeSize(tree), sizeFunc, &usage);
+    usage.totalBytes = usage.treeBytes + usage.nodeBytes + usage.payloadBytes + usage.slackBytes;
+    return usage;
+}
+
+/**
+ * start (or stop) keeping a running total of the tree's memory in its memoryUsage member.
+ * @param tree: the tree.
+ * @param sizeFunc: a function which returns the size of an item, NULL to stop tracking.
+ * @return: 0 on failure, other on success.
+ */
+int trackRBTreeMemory(RBTree *tree, SizeFunc sizeFunc)
+{
+    if (tree == NULL)
+    {
+        return FAILURE;
+    }
+    tree->sizeFunc = sizeFunc;
+    tree->memoryUsage = (sizeFunc == NULL) ? 0 : RBTreeMemoryUsage(tree, sizeFunc).totalBytes;
+    return SUCCESS;
+}
+
 /**
  * free all memory of the data structure.
  * @param tree: pointer to the tree to free.
@@ -683,5 +1440,36 @@ RBTree * newRBTree(CompareFunc compFunc, FreeFunc freeFunc)
     newTree->compFunc = compFunc;
     newTree->freeFunc = freeFunc;
     newTree->size = 0;
+    newTree->finger = NULL;
+    newTree->lowFunc = NULL;
+    newTree->highFunc = NULL;
+    newTree->log = NULL;
+    newTree->logFunc = NULL;
+    newTree->maxDeadRatio = 0;
+    newTree->deadCount = 0;
+    newTree->sizeFunc = NULL;
+    newTree->memoryUsage = 0;
+    return newTree;
+}
+
+/**
+ * constructs a new interval tree - an RBTree of intervals which supports overlap queries.
+ * @param compFunc: a function to compare two intervals, must order them by their low endpoint first.
+ * @param freeFunc: a function to free an interval.
+ * @param lowFunc, highFunc: functions which return the low and high endpoints of an interval.
+ */
+RBTree * newIntervalRBTree(CompareFunc compFunc, FreeFunc freeFunc, EndpointFunc lowFunc, EndpointFunc highFunc)
+{
+    if (lowFunc == NULL || highFunc == NULL)
+    {
+        return NULL;
+    }
+    RBTree *newTree = newRBTree(compFunc, freeFunc);
+    if (newTree == NULL)
+    {
+        return NULL;
+    }
+    newTree->lowFunc = lowFunc;
+    newTree->highFunc = highFunc;
     return newTree;
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef RBTREE_RBTREE_H
 #define RBTREE_RBTREE_H
 
+#include <stddef.h>
+
 // a color of a Node.
 typedef enum Color
 {
@@ -28,6 +30,35 @@ typedef int (*forEachFunc)(const void *object, void *args);
  */
 typedef void (*FreeFunc)(void *data);
 
+/**
+ * a function which returns an endpoint of an interval (used by interval trees).
+ * @data: an item of the tree.
+ * @return: the low or high endpoint of the item.
+ */
+typedef double (*EndpointFunc)(const void *data);
+
+/**
+ * a function which returns the memory size of an item (used by the memory accounting).
+ * @data: an item of the tree.
+ * @return: the number of bytes the item owns (including the memory it points to).
+ */
+typedef size_t (*SizeFunc)(const void *data);
+
+// operation codes of a LogFunc
+#define RB_LOG_INSERT 'I'
+#define RB_LOG_DELETE 'D'
+#define RB_LOG_UPDATE 'U'
+
+/**
+ * a function which records an operation of a tree before it is applied (set by setRBTreeLog, see RBTreeLog.h).
+ * @log: the log of the tree.
+ * @op: the operation (RB_LOG_INSERT, RB_LOG_DELETE or RB_LOG_UPDATE).
+ * @data: the item of the operation.
+ * @return: 0 on failure (the operation then fails), other on success.
+ */
+struct RBTreeLog;
+typedef int (*LogFunc)(struct RBTreeLog *log, char op, const void *data);
+
 /*
  * a node of the tree.
  */
@@ -35,8 +66,9 @@ typedef struct Node
 {
 	struct Node *parent, *left, *right;
 	Color color;
+	unsigned char dead; // lazy deletion only: the item was deleted, the node is kept until compaction.
 	void *data;
-} Node;
+} Node; // the nodes of interval trees are extended with the interval endpoints (IntervalNode in RBTree.c).
 
 /**
  * represents the tree
@@ -47,19 +79,49 @@ typedef struct RBTree
 	CompareFunc compFunc;
 	FreeFunc freeFunc;
 	long unsigned size;
+	Node *finger; // the last inserted node, the default hint of insertToRBTreeHint (NULL if unknown).
+	EndpointFunc lowFunc, highFunc; // interval trees only (NULL otherwise).
+	struct RBTreeLog *log; // if not NULL, the operations are appended to this log, and fail if they cannot be.
+	LogFunc logFunc; // the function which appends an operation to the log (NULL if there is no log).
+	double maxDeadRatio; // lazy deletion: the ratio of dead nodes which triggers compaction (0 - eager deletion).
+	long unsigned deadCount; // lazy deletion: the number of dead nodes (not counted in size).
+	SizeFunc sizeFunc; // memory tracking only: the item size function (NULL otherwise).
+	size_t memoryUsage; // memory tracking only: the running total of the tree's memory, in bytes.
 } RBTree;
 
+/**
+ * the memory footprint of a tree, in bytes.
+ */
+typedef struct RBTreeMemory
+{
+	size_t treeBytes; // the RBTree struct.
+	size_t nodeBytes; // the Node structs (including lazily deleted nodes).
+	size_t payloadBytes; // the items, as reported by the SizeFunc.
+	size_t slackBytes; // allocator overhead (headers and padding) of the RBTree and Node allocations.
+	size_t totalBytes; // the sum of all the above.
+	long unsigned nodeCount; // the number of nodes (including lazily deleted nodes).
+} RBTreeMemory;
+
 /**
  * constructs a new RBTree with the given CompareFunc.
  * comp: a function two compare two variables.
  */
 RBTree *newRBTree(CompareFunc compFunc, FreeFunc freeFunc); // implement it in RBTree.c
 
+/**
+ * constructs a new interval tree - an RBTree of intervals which supports overlap queries.
+ * @param compFunc: a function to compare two intervals, must order them by their low endpoint first.
+ * @param freeFunc: a function to free an interval.
+ * @param lowFunc, highFunc: functions which return the low and high endpoints of an interval.
+ */
+RBTree *newIntervalRBTree(CompareFunc compFunc, FreeFunc freeFunc, EndpointFunc lowFunc, EndpointFunc highFunc);
+
 /**
  * add an item to the tree
  * @param tree: the tree to add an item to.
  * @param data: item to add to the tree.
- * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ * @return: 0 on failure, other on success. (if the item is already in the tree, or the tree has a log and the
+ *          insertion cannot be appended to it - failure, and the tree is not changed).
  */
 int insertToRBTree(RBTree *tree, void *data); // implement it in RBTree.c
 
@@ -67,10 +129,58 @@ int insertToRBTree(RBTree *tree, void *data); // implement it in RBTree.c
  * remove an item from the tree
  * @param tree: the tree to remove an item from.
  * @param data: item to remove from the tree.
- * @return: 0 on failure, other on success. (if data is not in the tree - failure).
+ * @return: 0 on failure, other on success. (if data is not in the tree, or the tree has a log and the deletion
+ *          cannot be appended to it - failure, and the tree is not changed).
  */
 int deleteFromRBTree(RBTree *tree, void *data); // implement it in RBTree.c
 
+/**
+ * add an item to the tree, and get a handle to the node which stores it.
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @param handle: output - the node which stores data (may be NULL). valid until the item is deleted.
+ * @return: 0 on failure, other on success. (as insertToRBTree).
+ */
+int insertToRBTreeWithHandle(RBTree *tree, void *data, Node **handle);
+
+/**
+ * add an item to the tree, searching for its position upwards from a hint node and then down, instead of from
+ * the root. for (nearly) sorted input the hint should be the node of the previous item, which makes the insertion
+ * cost amortized O(1) comparisons.
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @param hint: a node of the tree, NULL for the tree's last insertion point.
+ * @return: 0 on failure, other on success. (as insertToRBTree).
+ */
+int insertToRBTreeHint(RBTree *tree, void *data, Node *hint);
+
+/**
+ * remove the item stored in a given node from the tree, without searching for it.
+ * @param tree: the tree to remove an item from.
+ * @param handle: a node of the tree (as returned by RBTreeFind or insertToRBTreeWithHandle).
+ * @return: 0 on failure, other on success. (as deleteFromRBTree).
+ */
+int deleteRBTreeNode(RBTree *tree, Node *handle);
+
+/**
+ * replace the item stored in a given node with an equal item (by the tree's CompareFunc), without searching
+ * for it. the old item is freed.
+ * @param tree: the tree which contains the node.
+ * @param handle: a node of the tree.
+ * @param newData: the new item, must be equal to the current item of the node.
+ * @return: 0 on failure, other on success. (if newData is not equal to the current item, or the tree has a log
+ *          and the update cannot be appended to it - failure, and the tree is not changed).
+ */
+int RBTreeReplaceData(RBTree *tree, Node *handle, void *newData);
+
+/**
+ * find the node which stores an item.
+ * @param tree: the tree to search in.
+ * @param data: item to search for.
+ * @return: the node of the item (a handle, valid until the item is deleted), NULL if it is not in the tree.
+ */
+Node *RBTreeFind(const RBTree *tree, const void *data);
+
 /**
  * check whether the tree RBTreeContains this item.
  * @param tree: the tree to add an item to.
@@ -89,6 +199,51 @@ int RBTreeContains(const RBTree *tree, const void *data); // implement it in RBT
  */
 int forEachRBTree(const RBTree *tree, forEachFunc func, void *args); // implement it in RBTree.c
 
+/**
+ * Activate a function on each item of an interval tree which overlaps the closed range [low, high], in an
+ * ascending order, in O(log(n) + k) for k overlapping items. if one of the activations of the function returns 0,
+ * the process stops.
+ * @param tree: an interval tree (see newIntervalRBTree).
+ * @param low, high: the range.
+ * @param func: the function to activate on the overlapping items.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success. (if the tree is not an interval tree - failure).
+ */
+int forEachOverlappingRBTree(const RBTree *tree, double low, double high, forEachFunc func, void *args);
+
+/**
+ * set the deletion mode of the tree. in lazy mode, a deletion only marks the node as dead (so it is skipped by
+ * searches and iterations), and the tree is compacted once the dead nodes pass a given ratio of its nodes.
+ * @param tree: the tree.
+ * @param maxDeadRatio: the ratio of dead nodes which triggers compaction, 0 for eager deletion.
+ * @return: 0 on failure, other on success.
+ */
+int setRBTreeLazyDeletion(RBTree *tree, double maxDeadRatio);
+
+/**
+ * remove the lazily deleted nodes from the tree, by rebuilding it in a single linear pass.
+ * @param tree: the tree to compact.
+ * @return: 0 on failure, other on success.
+ */
+int compactRBTree(RBTree *tree);
+
+/**
+ * measure the memory footprint of the tree, by visiting all of its nodes.
+ * @param tree: the tree.
+ * @param sizeFunc: a function which returns the size of an item (NULL - the items are not counted).
+ * @return: the memory footprint (all zero if tree is NULL).
+ */
+RBTreeMemory RBTreeMemoryUsage(const RBTree *tree, SizeFunc sizeFunc);
+
+/**
+ * start (or stop) keeping a running total of the tree's memory in its memoryUsage member, which the insertions,
+ * deletions and updates keep up to date in O(1). the total equals the totalBytes of RBTreeMemoryUsage.
+ * @param tree: the tree.
+ * @param sizeFunc: a function which returns the size of an item, NULL to stop tracking.
+ * @return: 0 on failure, other on success.
+ */
+int trackRBTreeMemory(RBTree *tree, SizeFunc sizeFunc);
+
 /**
  * free all memory of the data structure.
  * @param tree: pointer to the tree to free.
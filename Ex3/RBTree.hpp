@@ -0,0 +1,430 @@
+/**
+ * @file RBTree.hpp
+ * @author Ron Shuvy
+ * @brief This header file defines a generic Red-Black Tree container, with the same algorithms as RBTree.c.
+ * The item type and the comparator are template parameters, so the items are stored inside the nodes and the
+ * comparisons are inlined instead of being called through a CompareFunc pointer.
+ */
+
+#ifndef RBTREE_HPP
+#define RBTREE_HPP
+// ------------------------------ includes ------------------------------
+#include <cstddef>
+#include <functional>
+#include <utility>
+// ------------------------ class declaration ---------------------------
+// the template lives in its own namespace, so it can be used side by side with the C 'RBTree' struct of RBTree.h
+namespace rbtree
+{
+
+/**
+ * @class RBTree
+ * @brief sorted set of unique items, implemented as a Red-Black Tree
+ *
+ * @section Template parameters
+ * @param T type of the items.
+ * @param Compare a strict weak ordering of T (a < b), default is std::less<T>
+ *
+ * @section Member functions
+ *
+ * @fn bool insert(const T& val)
+ * @brief Add an item to the tree, returns false if the item is already in the tree
+ *
+ * @fn bool erase(const T& val)
+ * @brief Remove an item from the tree, returns false if the item is not in the tree
+ *
+ * @fn bool contains(const T& val)
+ * @brief Returns true if the item is in the tree, false otherwise
+ *
+ * @fn bool forEach(Func func)
+ * @brief Activate func on each item in an ascending order, stops (and returns false) once func returns false
+ *
+ * @fn size_t size()
+ * @brief Returns the number of items in the tree
+ *
+ * @fn void clear()
+ * @brief Remove all the items
+ */
+template <class T, class Compare = std::less<T>>
+class RBTree
+{
+public:
+    // constructor & destructor
+    explicit RBTree(Compare comp = Compare()) : _root(nullptr), _size(0), _comp(comp) {}
+    RBTree(const RBTree& rhs) = delete;
+    RBTree& operator=(const RBTree& rhs) = delete;
+    ~RBTree() { clear(); }
+
+    // capacity
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    // lookup
+    bool contains(const T& val) const { return _search(val) != nullptr; }
+    template <class Func> bool forEach(Func func) const { return _inOrder(_root, func); }
+
+    // modifiers
+    bool insert(const T& val);
+    bool erase(const T& val);
+    void clear() { _freeAllNodes(_root); _root = nullptr; _size = 0; }
+
+private:
+    enum Color { RED, BLACK };
+
+    /** @brief a node of the tree, the item is stored inline */
+    struct Node
+    {
+        Node *parent, *left, *right;
+        Color color;
+        T data;
+        Node(const T& val, Node *p) : parent(p), left(nullptr), right(nullptr), color(RED), data(val) {}
+    };
+
+    Node* _root; // the root of the tree
+    size_t _size; // number of items
+    Compare _comp; // items comparator
+
+    static bool _isRed(const Node *n) { return n != nullptr && n->color == RED; }
+
+    Node* _search(const T& val) const;
+    template <class Func> static bool _inOrder(const Node *root, Func& func);
+    static void _freeAllNodes(Node *root);
+
+    void _replaceChild(Node *parent, Node *old, Node *child);
+    void _leftRotation(Node *n);
+    void _rightRotation(Node *n);
+    void _repairRBTree(Node *n);
+    void _fixTreeStructure(Node *p, Node *s);
+    void _deleteNode(Node *m);
+};
+
+// ------------------------------ class definitions -----------------------------
+
+//--------- Utilities ---------
+
+template <class T, class Compare>
+typename RBTree<T, Compare>::Node* RBTree<T, Compare>::_search(const T& val) const
+{
+    // a single comparison per level: descend to the last node which is not greater than val, and check it for
+    // equivalence once at the end
+    Node *n = _root;
+    Node *lower = nullptr;
+    while (n != nullptr)
+    {
+        if (_comp(val, n->data))
+        {
+            n = n->left;
+        }
+        else
+        {
+            lower = n;
+            n = n->right;
+        }
+    }
+    return (lower != nullptr && !_comp(lower->data, val)) ? lower : nullptr;
+}
+
+template <class T, class Compare>
+template <class Func>
+bool RBTree<T, Compare>::_inOrder(const Node *root, Func& func)
+{
+    if (root == nullptr)
+    {
+        return true;
+    }
+    if (!_inOrder(root->left, func) || !func(root->data))
+    {
+        return false;
+    }
+    return _inOrder(root->right, func);
+}
+
+template <class T, class Compare>
+void RBTree<T, Compare>::_freeAllNodes(Node *root)
+{
+    if (root == nullptr)
+    {
+        return;
+    }
+    _freeAllNodes(root->left);
+    _freeAllNodes(root->right);
+    delete root;
+}
+
+template <class T, class Compare>
+void RBTree<T, Compare>::_replaceChild(Node *parent, Node *old, Node *child)
+{
+    if (parent == nullptr)
+    {
+        _root = child;
+    }
+    else if (parent->left == old)
+    {
+        parent->left = child;
+    }
+    else
+    {
+        parent->right = child;
+    }
+}
+
+template <class T, class Compare>
+void RBTree<T, Compare>::_leftRotation(Node *n)
+{
+    Node *rightChild = n->right;
+    Node *grandson = rightChild->left;
+
+    n->right = grandson;
+    if (grandson != nullptr)
+    {
+        grandson->parent = n;
+    }
+    _replaceChild(n->parent, n, rightChild);
+    rightChild->parent = n->parent;
+    rightChild->left = n;
+    n->parent = rightChild;
+}
+
+template <class T, class Compare>
+void RBTree<T, Compare>::_rightRotation(Node *n)
+{
+    Node *leftChild = n->left;
+    Node *grandson = leftChild->right;
+
+    n->left = grandson;
+    if (grandson != nullptr)
+    {
+        grandson->parent = n;
+    }
+    _replaceChild(n->parent, n, leftChild);
+    leftChild->parent = n->parent;
+    leftChild->right = n;
+    n->parent = leftChild;
+}
+
+//--------- Insertion ---------
+
+template <class T, class Compare>
+void RBTree<T, Compare>::_repairRBTree(Node *n)
+{
+    while (true)
+    {
+        if (n->parent == nullptr)
+        {
+            // case 1
+            n->color = BLACK;
+            return;
+        }
+
+        Node *p = n->parent;
+        if (p->color == BLACK)
+        {
+            // case 2
+            return;
+        }
+
+        Node *g = p->parent;
+        Node *u = (g->left == p) ? g->right : g->left;
+        if (_isRed(u))
+        {
+            // case 3
+            p->color = BLACK;
+            u->color = BLACK;
+            g->color = RED;
+            n = g;
+            continue;
+        }
+
+        // case 4a
+        if (g->left == p && p->right == n)
+        {
+            _leftRotation(p);
+            std::swap(n, p);
+        }
+        else if (g->right == p && p->left == n)
+        {
+            _rightRotation(p);
+            std::swap(n, p);
+        }
+
+        // case 4b
+        if (g->left == p)
+        {
+            _rightRotation(g);
+        }
+        else
+        {
+            _leftRotation(g);
+        }
+        // case 4c
+        p->color = BLACK;
+        g->color = RED;
+        return;
+    }
+}
+
+template <class T, class Compare>
+bool RBTree<T, Compare>::insert(const T& val)
+{
+    Node *parent = nullptr;
+    Node *lower = nullptr; // the last node which is not greater than val
+    Node **position = &_root;
+    while (*position != nullptr)
+    {
+        parent = *position;
+        if (_comp(val, parent->data))
+        {
+            position = &(parent->left);
+        }
+        else
+        {
+            lower = parent;
+            position = &(parent->right);
+        }
+    }
+    if (lower != nullptr && !_comp(lower->data, val))
+    {
+        // the tree already contains the given item
+        return false;
+    }
+
+    Node *newNode = new Node(val, parent);
+    *position = newNode;
+    ++_size;
+    _repairRBTree(newNode);
+    return true;
+}
+
+//--------- Deletion ---------
+
+template <class T, class Compare>
+void RBTree<T, Compare>::_fixTreeStructure(Node *p, Node *s)
+{
+    while (p != nullptr && s != nullptr)
+    {
+        // ----------case 3b--------------
+        if (s->color == BLACK && !_isRed(s->left) && !_isRed(s->right))
+        {
+            s->color = RED;
+            if (p->color == RED)
+            {
+                // ----------case 3b-i-------------
+                p->color = BLACK;
+                return;
+            }
+            // ----------case 3b-ii-------------
+            Node *g = p->parent;
+            s = (g == nullptr) ? nullptr : ((g->left == p) ? g->right : g->left);
+            p = g;
+            continue;
+        }
+
+        // ----------case 3c--------------
+        if (s->color == RED)
+        {
+            s->color = BLACK;
+            p->color = RED;
+            if (p->left != s)
+            {
+                _leftRotation(p);
+                s = p->right;
+            }
+            else
+            {
+                _rightRotation(p);
+                s = p->left;
+            }
+            continue;
+        }
+
+        Node *sc = (p->left == s) ? s->right : s->left; // sibling's child close to the deleted node
+        Node *sf = (p->left == s) ? s->left : s->right; // sibling's child far from the deleted node
+
+        // ----------case 3d--------------
+        if (_isRed(sc) && !_isRed(sf))
+        {
+            sc->color = BLACK;
+            s->color = RED;
+            if (p->left != s)
+            {
+                _rightRotation(s);
+            }
+            else
+            {
+                _leftRotation(s);
+            }
+            s = sc;
+            continue;
+        }
+
+        // ----------case 3e--------------
+        std::swap(s->color, p->color);
+        if (p->left != s)
+        {
+            _leftRotation(p);
+        }
+        else
+        {
+            _rightRotation(p);
+        }
+        sf->color = BLACK;
+        return;
+    }
+}
+
+template <class T, class Compare>
+void RBTree<T, Compare>::_deleteNode(Node *m)
+{
+    Node *p = m->parent;
+    Node *c = (m->left != nullptr) ? m->left : m->right;
+
+    // ----------case 1--------------
+    if (m->color == RED)
+    {
+        _replaceChild(p, m, nullptr);
+        delete m;
+        return;
+    }
+
+    // ----------case 2--------------
+    if (_isRed(c))
+    {
+        m->left = m->right = nullptr;
+        std::swap(m->data, c->data);
+        delete c;
+        return;
+    }
+
+    // ----------case 3--------------
+    Node *s = (p == nullptr) ? nullptr : ((p->left == m) ? p->right : p->left);
+    _replaceChild(p, m, nullptr);
+    delete m;
+    _fixTreeStructure(p, s);
+}
+
+template <class T, class Compare>
+bool RBTree<T, Compare>::erase(const T& val)
+{
+    Node *m = _search(val);
+    if (m == nullptr)
+    {
+        return false;
+    }
+    if (m->left != nullptr && m->right != nullptr)
+    {
+        Node *s = m->right;
+        while (s->left != nullptr)
+        {
+            s = s->left;
+        }
+        std::swap(m->data, s->data);
+        m = s;
+    }
+    _deleteNode(m);
+    --_size;
+    return true;
+}
+
+} // namespace rbtree
+
+#endif //RBTREE_HPP
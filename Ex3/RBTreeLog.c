@@ -0,0 +1,565 @@
+/**
+ * @file RBTreeLog.c
+ * @author Ron Shuvy
+ *
+ * @brief This file implements a write-ahead log and snapshots for durable RBTrees
+ *
+ * @section DESCRIPTION
+ * A log record is framed by a header - the length of its body and the CRC-32 of its body (both 32 bit, in the
+ * host byte order) - and its body is a single operation byte followed by the item, as written by the
+ * SerializeFunc. A snapshot is the sequence of the tree items in an ascending order.
+ * Recovery loads the snapshot and then replays the log records on top of it, up to the first record which is
+ * incomplete or does not match its CRC, and cuts the log there so new records follow the last intact one.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "RBTreeLog.h"
+
+#define SUCCESS 1
+#define FAILURE 0
+#define TEMP_SUFFIX ".tmp"
+#define CRC32_POLYNOMIAL 0xEDB88320u // the reflected CRC-32 (IEEE 802.3) polynomial
+#define LOG_FILE_MODE 0644
+#define TORN_RECORD (-1)
+#define NO_MEMORY (-2)
+
+// ------------------------------ Functions -----------------------------
+
+// ---------------- Utilities ----------------
+
+/**
+ * arguments of writeItem
+ */
+typedef struct SnapshotWriter
+{
+	FILE *file;
+	SerializeFunc serializeFunc;
+} SnapshotWriter;
+
+/**
+ * forEach function which writes an item to a snapshot file
+ */
+static int writeItem(const void *object, void *args)
+{
+    SnapshotWriter *writer = (SnapshotWriter *)args;
+    return writer->serializeFunc(object, writer->file);
+}
+
+/**
+ * the header of a log record
+ */
+typedef struct RecordHeader
+{
+	uint32_t length; // the size of the record body, in bytes
+	uint32_t crc; // the CRC-32 of the record body
+} RecordHeader;
+
+/**
+ * Computes the CRC-32 of a buffer
+ * @param data: the buffer
+ * @param length: the size of the buffer, in bytes
+ * @return: the CRC-32 of the buffer
+ */
+static uint32_t crc32(const unsigned char *data, size_t length)
+{
+    static uint32_t table[256];
+    static int tableReady = 0;
+    if (!tableReady)
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                c = (c & 1) ? (CRC32_POLYNOMIAL ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+        tableReady = 1;
+    }
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/**
+ * Flushes a file and waits until its content is on the disk
+ * @return: FAILURE if the flush failed, SUCCESS otherwise
+ */
+static int syncFile(FILE *file)
+{
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0)
+    {
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+/**
+ * Waits until the directory entries of a file (e.g. a rename into it) are on the disk
+ * @param path: the file path
+ * @return: FAILURE if the directory cannot be synced, SUCCESS otherwise
+ */
+static int syncParentDirectory(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    size_t length = (slash == NULL) ? 1 : (slash == path) ? 1 : (size_t)(slash - path);
+    char *directory = (char *)malloc(length + 1);
+    if (directory == NULL)
+    {
+        return FAILURE;
+    }
+    if (slash == NULL)
+    {
+        strcpy(directory, ".");
+    }
+    else
+    {
+        memcpy(directory, path, length);
+        directory[length] = '\0';
+    }
+    int fd = open(directory, O_RDONLY);
+    free(directory);
+    if (fd < 0)
+    {
+        return FAILURE;
+    }
+    int success = (fsync(fd) == 0);
+    success = (close(fd) == 0) && success;
+    return success ? SUCCESS : FAILURE;
+}
+
+/**
+ * Cuts a file at a given size, and waits until the change is on the disk
+ * @param path: the file path
+ * @param size: the new size of the file
+ * @return: FAILURE if the file cannot be truncated, SUCCESS otherwise
+ */
+static int truncateFile(const char *path, long size)
+{
+    int fd = open(path, O_WRONLY);
+    if (fd < 0)
+    {
+        return FAILURE;
+    }
+    int success = (ftruncate(fd, (off_t)size) == 0) && (fsync(fd) == 0);
+    success = (close(fd) == 0) && success;
+    return success ? SUCCESS : FAILURE;
+}
+
+/**
+ * Reads the next intact record of a log
+ * @param file: the log, at the start of a record
+ * @param remaining: the number of bytes from the start of the record to the end of the log
+ * @param body: in/output - a buffer for the record body, which grows as needed (freed by the caller)
+ * @param capacity: in/output - the size of the buffer
+ * @return: the length of the record body, TORN_RECORD if the log ends, or the record is incomplete or corrupt,
+ *          and NO_MEMORY if the body cannot be read into memory
+ */
+static long readRecord(FILE *file, long remaining, unsigned char **body, size_t *capacity)
+{
+    RecordHeader header;
+    if (remaining < (long)sizeof(header) || fread(&header, sizeof(header), 1, file) != 1 || header.length == 0 ||
+        header.length > (uint32_t)(remaining - (long)sizeof(header)))
+    {
+        return TORN_RECORD;
+    }
+    if (header.length > *capacity)
+    {
+        unsigned char *grown = (unsigned char *)realloc(*body, header.length);
+        if (grown == NULL)
+        {
+            return NO_MEMORY;
+        }
+        *body = grown;
+        *capacity = header.length;
+    }
+    if (fread(*body, 1, header.length, file) != header.length || crc32(*body, header.length) != header.crc)
+    {
+        return TORN_RECORD;
+    }
+    return (long)header.length;
+}
+
+/**
+ * Replays a single log operation on a tree
+ * @param tree: the tree
+ * @param op: the operation
+ * @param item: the item of the operation (owned by this function)
+ * @return: FAILURE if op is not a known operation, SUCCESS otherwise
+ */
+static int replayRecord(RBTree *tree, int op, void *item)
+{
+    if (op == RB_LOG_INSERT)
+    {
+        if (!insertToRBTree(tree, item))
+        {
+            tree->freeFunc(item);
+        }
+        return SUCCESS;
+    }
+    if (op == RB_LOG_DELETE)
+    {
+        deleteFromRBTree(tree, item);
+        tree->freeFunc(item);
+        return SUCCESS;
+    }
+    if (op == RB_LOG_UPDATE)
+    {
+        if (!RBTreeReplaceData(tree, RBTreeFind(tree, item), item))
+        {
+            tree->freeFunc(item);
+        }
+        return SUCCESS;
+    }
+    tree->freeFunc(item);
+    return FAILURE;
+}
+
+/**
+ * Removes the record which is being appended from the end of a log (best effort), after it failed to be written
+ * or committed, and marks the log as failed
+ * @param log: the log
+ */
+static void discardRecord(RBTreeLog *log)
+{
+    if (ftruncate(log->fd, (off_t)log->size) == 0)
+    {
+        fsync(log->fd);
+    }
+    log->failed = 1;
+}
+
+/**
+ * Writes a whole buffer to a file descriptor
+ * @return: FAILURE if the buffer could not be written, SUCCESS otherwise
+ */
+static int writeAll(int fd, const char *buffer, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t written = write(fd, buffer, length);
+        if (written <= 0)
+        {
+            return FAILURE;
+        }
+        buffer += written;
+        length -= (size_t)written;
+    }
+    return SUCCESS;
+}
+
+// ---------------- Header ----------------
+
+/**
+ * opens (or creates) a log file for appending.
+ * @param path: the log file path.
+ * @param serializeFunc: a function to write an item.
+ * @param commitInterval: number of records between two commits (0 or 1 - commit every record).
+ * @return: the log, NULL on failure.
+ */
+RBTreeLog *openRBTreeLog(const char *path, SerializeFunc serializeFunc, unsigned int commitInterval)
+{
+    if (path == NULL || serializeFunc == NULL)
+    {
+        return NULL;
+    }
+    RBTreeLog *log = (RBTreeLog *)malloc(sizeof(RBTreeLog));
+    if (log == NULL)
+    {
+        return NULL;
+    }
+    log->record = NULL;
+    log->recordCapacity = 0;
+    log->fd = open(path, O_WRONLY | O_CREAT | O_APPEND, LOG_FILE_MODE);
+    log->recordStream = open_memstream(&log->record, &log->recordCapacity);
+    off_t size = (log->fd < 0) ? -1 : lseek(log->fd, 0, SEEK_END);
+    if (size < 0 || log->recordStream == NULL)
+    {
+        if (log->fd >= 0)
+        {
+            close(log->fd);
+        }
+        if (log->recordStream != NULL)
+        {
+            fclose(log->recordStream);
+        }
+        free(log->record);
+        free(log);
+        return NULL;
+    }
+    log->size = (long)size;
+    log->serializeFunc = serializeFunc;
+    log->commitInterval = commitInterval;
+    log->pending = 0;
+    log->failed = 0;
+    return log;
+}
+
+/**
+ * sets the log of a tree.
+ * @param tree: the tree.
+ * @param log: the log, NULL to stop logging.
+ * @return: 0 on failure, other on success.
+ */
+int setRBTreeLog(RBTree *tree, RBTreeLog *log)
+{
+    if (tree == NULL)
+    {
+        return FAILURE;
+    }
+    tree->log = log;
+    tree->logFunc = (log == NULL) ? NULL : &appendRBTreeLog;
+    return SUCCESS;
+}
+
+/**
+ * appends a record to the log, and commits the log if the commit interval has passed.
+ * @param log: the log.
+ * @param op: the record operation (RB_LOG_INSERT, RB_LOG_DELETE, RB_LOG_UPDATE).
+ * @param data: the item of the operation.
+ * @return: 0 on failure, other on success.
+ */
+int appendRBTreeLog(RBTreeLog *log, char op, const void *data)
+{
+    if (log == NULL || data == NULL || log->failed)
+    {
+        return FAILURE;
+    }
+    // the record is built in memory (a placeholder header, then the body), so its length and CRC are known
+    // before it is written with a single write
+    RecordHeader header = {0, 0};
+    FILE *stream = log->recordStream;
+    if (fseek(stream, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, stream) != 1 ||
+        fputc(op, stream) == EOF || !log->serializeFunc(data, stream) || fflush(stream) != 0)
+    {
+        // nothing was written to the log
+        return FAILURE;
+    }
+    long length = ftell(stream);
+    header.length = (uint32_t)(length - (long)sizeof(header));
+    header.crc = crc32((const unsigned char *)log->record + sizeof(header), header.length);
+    memcpy(log->record, &header, sizeof(header));
+
+    if (!writeAll(log->fd, log->record, (size_t)length))
+    {
+        discardRecord(log);
+        return FAILURE;
+    }
+    log->pending += 1;
+    if (log->pending >= log->commitInterval && !commitRBTreeLog(log))
+    {
+        discardRecord(log);
+        return FAILURE;
+    }
+    log->size += length;
+    return SUCCESS;
+}
+
+/**
+ * writes all the appended records to the disk (group commit).
+ * @param log: the log.
+ * @return: 0 on failure (of this commit or of a previous append), other on success.
+ */
+int commitRBTreeLog(RBTreeLog *log)
+{
+    if (log == NULL)
+    {
+        return FAILURE;
+    }
+    if (fsync(log->fd) != 0)
+    {
+        log->failed = 1;
+    }
+    log->pending = 0;
+    return log->failed ? FAILURE : SUCCESS;
+}
+
+/**
+ * writes all the items of a tree to a snapshot file, through a temporary file.
+ * @param tree: the tree.
+ * @param path: the snapshot file path.
+ * @param serializeFunc: a function to write an item.
+ * @return: 0 on failure, other on success.
+ */
+int saveRBTreeSnapshot(const RBTree *tree, const char *path, SerializeFunc serializeFunc)
+{
+    if (tree == NULL || path == NULL || serializeFunc == NULL)
+    {
+        return FAILURE;
+    }
+    char *tempPath = (char *)malloc(strlen(path) + strlen(TEMP_SUFFIX) + 1);
+    if (tempPath == NULL)
+    {
+        return FAILURE;
+    }
+    strcpy(tempPath, path);
+    strcat(tempPath, TEMP_SUFFIX);
+
+    FILE *file = fopen(tempPath, "wb");
+    if (file == NULL)
+    {
+        free(tempPath);
+        return FAILURE;
+    }
+    SnapshotWriter writer = {file, serializeFunc};
+    int success = forEachRBTree(tree, writeItem, &writer) && syncFile(file);
+    success = (fclose(file) == 0) && success;
+    success = success && (rename(tempPath, path) == 0);
+    if (!success)
+    {
+        remove(tempPath);
+    }
+    free(tempPath);
+    // the rename is only durable once the directory is on the disk as well
+    return (success && syncParentDirectory(path)) ? SUCCESS : FAILURE;
+}
+
+/**
+ * writes a snapshot of a tree, and then empties the tree's log.
+ * @param tree: a tree with a log.
+ * @param snapshotPath: the snapshot file path.
+ * @return: 0 on failure, other on success.
+ */
+int checkpointRBTree(RBTree *tree, const char *snapshotPath)
+{
+    if (tree == NULL || tree->log == NULL)
+    {
+        return FAILURE;
+    }
+    RBTreeLog *log = tree->log;
+    if (!commitRBTreeLog(log) || !saveRBTreeSnapshot(tree, snapshotPath, log->serializeFunc))
+    {
+        return FAILURE;
+    }
+    // the log is opened for appending, so the next records are written from the start of the emptied file
+    if (ftruncate(log->fd, 0) != 0 || fsync(log->fd) != 0)
+    {
+        log->failed = 1;
+        return FAILURE;
+    }
+    log->size = 0;
+    return SUCCESS;
+}
+
+/**
+ * Replays the intact records of a log on a tree, and cuts the log after the last of them
+ * @param tree: the tree
+ * @param logPath: the log file path
+ * @param deserializeFunc: a function to read an item
+ * @return: FAILURE if an intact record cannot be replayed or the log cannot be cut, SUCCESS otherwise
+ */
+static int replayLog(RBTree *tree, const char *logPath, DeserializeFunc deserializeFunc)
+{
+    FILE *file = fopen(logPath, "rb");
+    if (file == NULL)
+    {
+        return SUCCESS;
+    }
+    long fileSize = -1;
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        fileSize = ftell(file);
+    }
+    if (fileSize < 0 || fseek(file, 0, SEEK_SET) != 0)
+    {
+        fclose(file);
+        return FAILURE;
+    }
+
+    unsigned char *body = NULL;
+    size_t capacity = 0;
+    long validEnd = 0; // the end of the last intact record
+    int success = SUCCESS;
+    while (success)
+    {
+        long length = readRecord(file, fileSize - validEnd, &body, &capacity);
+        if (length == TORN_RECORD)
+        {
+            // a record which was not fully written before the crash (and anything after it)
+            break;
+        }
+        FILE *record = (length == NO_MEMORY) ? NULL : fmemopen(body, (size_t)length, "rb");
+        if (record == NULL)
+        {
+            success = FAILURE;
+            break;
+        }
+        int op = fgetc(record);
+        void *item = deserializeFunc(record);
+        fclose(record);
+        // an intact record which cannot be read is not a crash artifact - the recovery fails
+        success = (item != NULL) && replayRecord(tree, op, item);
+        validEnd += (long)sizeof(RecordHeader) + length;
+    }
+    free(body);
+    fclose(file);
+    if (success && validEnd < fileSize)
+    {
+        success = truncateFile(logPath, validEnd);
+    }
+    return success;
+}
+
+/**
+ * rebuilds a tree from the latest snapshot and the log of the operations which followed it.
+ * @param tree: an empty tree, with no log set.
+ * @param snapshotPath: the snapshot file path.
+ * @param logPath: the log file path.
+ * @param deserializeFunc: a function to read an item.
+ * @return: 0 on failure, other on success.
+ */
+int recoverRBTree(RBTree *tree, const char *snapshotPath, const char *logPath, DeserializeFunc deserializeFunc)
+{
+    if (tree == NULL || tree->log != NULL || deserializeFunc == NULL)
+    {
+        return FAILURE;
+    }
+
+    FILE *file = (snapshotPath == NULL) ? NULL : fopen(snapshotPath, "rb");
+    if (file != NULL)
+    {
+        void *item;
+        while ((item = deserializeFunc(file)) != NULL)
+        {
+            // the snapshot is sorted - each item is inserted next to the previous one
+            if (!insertToRBTreeHint(tree, item, NULL))
+            {
+                tree->freeFunc(item);
+            }
+        }
+        fclose(file);
+    }
+
+    if (logPath == NULL)
+    {
+        return SUCCESS;
+    }
+    return replayLog(tree, logPath, deserializeFunc);
+}
+
+/**
+ * commits and closes a log.
+ * @param log: pointer to the log to close.
+ */
+void closeRBTreeLog(RBTreeLog **log)
+{
+    if (log == NULL || *log == NULL)
+    {
+        return;
+    }
+    commitRBTreeLog(*log);
+    close((*log)->fd);
+    fclose((*log)->recordStream);
+    free((*log)->record);
+    free(*log);
+    *log = NULL;
+}
@@ -0,0 +1,113 @@
+#ifndef RBTREE_RBTREELOG_H
+#define RBTREE_RBTREELOG_H
+
+#include <stdio.h>
+#include "RBTree.h"
+
+/**
+ * a function to write an item to a binary file.
+ * @data: an item of the tree.
+ * @out: the file to write to.
+ * @return: 0 on failure, other on success.
+ */
+typedef int (*SerializeFunc)(const void *data, FILE *out);
+
+/**
+ * a function to read an item which was written by a SerializeFunc.
+ * @in: the file to read from.
+ * @return: a new (dynamically allocated) item, NULL on failure or at the end of the file.
+ */
+typedef void *(*DeserializeFunc)(FILE *in);
+
+/**
+ * an append-only log of the operations on a tree. while a log is set on a tree (see setRBTreeLog), every
+ * insertion, deletion and update of the tree appends a record, and fails (leaving the tree unchanged) if the
+ * record cannot be appended. each record carries its length and a CRC, so recovery can tell a record which was
+ * torn by a crash. the records are flushed to the disk (fsync) once in commitInterval records, so a crash loses
+ * at most the records of the last interval.
+ */
+typedef struct RBTreeLog
+{
+	int fd; // the log file, opened for appending
+	FILE *recordStream; // an in-memory stream, in which a record is built before it is written
+	char *record; // the buffer of recordStream
+	size_t recordCapacity; // the size of the buffer of recordStream
+	long size; // the size of the log file, up to the end of the last appended record
+	SerializeFunc serializeFunc;
+	unsigned int commitInterval; // number of records between two commits
+	unsigned int pending; // number of records since the last commit
+	int failed; // whether an append or a commit failed since the log was opened - every later append fails
+} RBTreeLog;
+
+/**
+ * opens (or creates) a log file for appending.
+ * @param path: the log file path.
+ * @param serializeFunc: a function to write an item.
+ * @param commitInterval: number of records between two commits (0 or 1 - commit every record).
+ * @return: the log, NULL on failure.
+ */
+RBTreeLog *openRBTreeLog(const char *path, SerializeFunc serializeFunc, unsigned int commitInterval);
+
+/**
+ * sets the log of a tree, to which the tree's operations are appended from now on. the operation codes of the
+ * records are those of a LogFunc (RB_LOG_INSERT, RB_LOG_DELETE, RB_LOG_UPDATE).
+ * @param tree: the tree.
+ * @param log: the log (which must outlive its use by the tree), NULL to stop logging.
+ * @return: 0 on failure, other on success.
+ */
+int setRBTreeLog(RBTree *tree, RBTreeLog *log);
+
+/**
+ * appends a record to the log, and commits the log if the commit interval has passed. if the record cannot be
+ * written or committed it is removed from the log (as far as possible), and the log is marked as failed.
+ * @param log: the log.
+ * @param op: the record operation (RB_LOG_INSERT, RB_LOG_DELETE, RB_LOG_UPDATE).
+ * @param data: the item of the operation.
+ * @return: 0 on failure (including a log which has failed before), other on success.
+ */
+int appendRBTreeLog(RBTreeLog *log, char op, const void *data);
+
+/**
+ * writes all the appended records to the disk (group commit).
+ * @param log: the log.
+ * @return: 0 on failure (of this commit or of a previous append), other on success.
+ */
+int commitRBTreeLog(RBTreeLog *log);
+
+/**
+ * writes all the items of a tree to a snapshot file. the snapshot is written to a temporary file which then
+ * replaces the given path (and the directory is synced), so a crash leaves either the old or the new snapshot.
+ * @param tree: the tree.
+ * @param path: the snapshot file path.
+ * @param serializeFunc: a function to write an item.
+ * @return: 0 on failure, other on success.
+ */
+int saveRBTreeSnapshot(const RBTree *tree, const char *path, SerializeFunc serializeFunc);
+
+/**
+ * writes a snapshot of a tree, and then empties the tree's log (the snapshot contains all of its records).
+ * @param tree: a tree with a log.
+ * @param snapshotPath: the snapshot file path.
+ * @return: 0 on failure, other on success.
+ */
+int checkpointRBTree(RBTree *tree, const char *snapshotPath);
+
+/**
+ * rebuilds a tree from the latest snapshot and the log of the operations which followed it. a missing file is
+ * treated as empty. the log is replayed up to its first incomplete or corrupt record (a record torn by a crash),
+ * and is then truncated after the last intact record, so records appended later are not lost behind the tear.
+ * @param tree: an empty tree, with no log set.
+ * @param snapshotPath: the snapshot file path.
+ * @param logPath: the log file path.
+ * @param deserializeFunc: a function to read an item.
+ * @return: 0 on failure, other on success.
+ */
+int recoverRBTree(RBTree *tree, const char *snapshotPath, const char *logPath, DeserializeFunc deserializeFunc);
+
+/**
+ * commits and closes a log.
+ * @param log: pointer to the log to close.
+ */
+void closeRBTreeLog(RBTreeLog **log);
+
+#endif //RBTREE_RBTREELOG_H
@@ -0,0 +1,140 @@
+/**
+ * @file frozenbench.c
+ * @author Ron Shuvy
+ *
+ * @brief compares the lookups of an RBTree of int keys to those of its snapshots
+ *
+ * @section DESCRIPTION
+ * Inserts BENCH_KEYS keys (each a separate allocation) in a random order, then times BENCH_LOOKUPS random
+ * contains queries (about half of them hits) on the tree, on RBTreeFreeze and on RBTreeFreezeInline, and prints
+ * the time of a lookup in each and its speedup over the tree. the number of keys may be given as an argument.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "RBTree.h"
+#include "FrozenRBTree.h"
+
+#define BENCH_KEYS 1000000
+#define BENCH_LOOKUPS 2000000
+#define USAGE_MSG "Usage: ./frozenbench [keys]\n"
+
+/**
+ * compares two int items
+ */
+static int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * a lookup in one of the structures
+ */
+typedef int (*LookupFunc)(const void *structure, const void *data);
+
+/**
+ * RBTreeContains, as a LookupFunc
+ */
+static int treeLookup(const void *structure, const void *data)
+{
+    return RBTreeContains((const RBTree *)structure, data);
+}
+
+/**
+ * frozenRBTreeContains, as a LookupFunc
+ */
+static int frozenLookup(const void *structure, const void *data)
+{
+    return frozenRBTreeContains((const FrozenRBTree *)structure, data);
+}
+
+/**
+ * times the lookups of the queries in a structure, and prints the time of a lookup
+ * @param base: the time of a lookup in the tree, 0 for the tree itself
+ * @return: the time of a lookup, in nanoseconds
+ */
+static double timeLookups(const char *name, LookupFunc lookup, const void *structure, const int *queries,
+                          int count, double base)
+{
+    long unsigned found = 0;
+    clock_t start = clock();
+    for (int i = 0; i < count; ++i)
+    {
+        found += (lookup(structure, &queries[i]) != 0);
+    }
+    double ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / count;
+    printf("%s: %.1f ns per lookup (%lu found)", name, ns, found);
+    if (base > 0)
+    {
+        printf(", x%.2f", base / ns);
+    }
+    printf("\n");
+    return ns;
+}
+
+/**
+ * Program's main
+ */
+int main(int argc, char **argv)
+{
+    int n = (argc > 1) ? atoi(argv[1]) : BENCH_KEYS;
+    if (argc > 2 || n <= 0)
+    {
+        fprintf(stderr, USAGE_MSG);
+        return EXIT_FAILURE;
+    }
+    srand(0);
+    int *keys = (int *)malloc(sizeof(int) * n);
+    int *queries = (int *)malloc(sizeof(int) * BENCH_LOOKUPS);
+    RBTree *tree = newRBTree(compareInts, free);
+    if (keys == NULL || queries == NULL || tree == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        keys[i] = 2 * i;
+    }
+    for (int i = n - 1; i > 0; --i)
+    {
+        int j = rand() % (i + 1), swap = keys[i];
+        keys[i] = keys[j], keys[j] = swap;
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        int *key = (int *)malloc(sizeof(int));
+        if (key == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+        *key = keys[i];
+        if (!insertToRBTree(tree, key))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    for (int i = 0; i < BENCH_LOOKUPS; ++i)
+    {
+        queries[i] = rand() % (2 * n);
+    }
+
+    FrozenRBTree *frozen = RBTreeFreeze(tree);
+    FrozenRBTree *inlined = RBTreeFreezeInline(tree, sizeof(int));
+    if (frozen == NULL || inlined == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    printf("%d keys, %d lookups\n", n, BENCH_LOOKUPS);
+    double base = timeLookups("RBTree", treeLookup, tree, queries, BENCH_LOOKUPS, 0);
+    timeLookups("RBTreeFreeze", frozenLookup, frozen, queries, BENCH_LOOKUPS, base);
+    timeLookups("RBTreeFreezeInline", frozenLookup, inlined, queries, BENCH_LOOKUPS, base);
+
+    freeFrozenRBTree(&frozen);
+    freeFrozenRBTree(&inlined);
+    freeRBTree(&tree);
+    free(keys);
+    free(queries);
+    return EXIT_SUCCESS;
+}
@@ -2,7 +2,12 @@
 // Created by Maor on 21/05/2020.
 //
 
+#define _POSIX_C_SOURCE 200809L // truncate, for tearing the log
+
 #include "RBTree.h"
+#include "FrozenRBTree.h"
+#include "IntrusiveRBTree.h"
+#include "RBTreeLog.h"
 #include "RBUtilities.h"
 #include "Structs.h"
 #include <stdio.h>
@@ -10,6 +15,8 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <time.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 #define LAST_NUMBER_OF_NODES_TO_CHECK 2000
@@ -22,6 +29,28 @@
 #define MAX_INT_VALUE_CHECK 2000
 #define MAX_INPUT_TO_SHOW_TREE 25
 #define CHECK_DELETE true
+#define HANDLE_NODES 2000
+#define HINT_NODES 100000
+#define MAX_HINT_COMPARISONS 4 // per insertion of sorted items
+#define INTERVAL_NODES 2000
+#define INTERVAL_QUERIES 500
+#define MAX_INTERVAL_VALUE 10000
+#define MAX_INTERVAL_LENGTH 500
+#define LAZY_NODES 4000
+#define MAX_DEAD_RATIO 0.25
+#define MEMORY_NODES 2000
+#define WAL_KEYS 500
+#define WAL_OPERATIONS 2000
+#define WAL_COMMIT_INTERVAL 16
+#define WAL_TORN_BYTES 3
+#define WAL_SNAPSHOT "tests_wal.snapshot"
+#define WAL_LOG "tests_wal.log"
+#define FROZEN_MAX_SIZE 300
+#define FROZEN_MAX_KEY (4 * FROZEN_MAX_SIZE) // the keys of a snapshot are in [0, FROZEN_MAX_KEY)
+#define FROZEN_RANGES 20 // range queries per snapshot
+#define INTRUSIVE_KEYS 500
+#define INTRUSIVE_OPERATIONS 5000
+#define INTRUSIVE_OWNED_ITEMS 100
 
 int compInt(void* data1, void* data2)
 {
@@ -311,9 +340,711 @@ void vectorTree()
     printf("\n\n*****passed the test of vectors tree*****\n\n");
 }
 
+int* newInt(const int value)
+{
+    int* toReturn = (int*) malloc(sizeof(int));
+    *toReturn = value;
+    return toReturn;
+}
+
+void shuffle(int* arr, const int n)
+{
+    for(int i = n - 1; i > 0; i--)
+    {
+        int j = rand() % (i + 1);
+        int tmp = arr[i];
+        arr[i] = arr[j];
+        arr[j] = tmp;
+    }
+}
+
+void check(RBTree* t, const bool condition, const char* message)
+{
+    if(!condition)
+    {
+        printf("ERROR - %s\n", message);
+        freeRBTree(&t);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void handleTree()
+{
+    RBTree* t = newRBTree((CompareFunc) &compInt, &free);
+    Node** handles = (Node**) malloc(sizeof(Node*) * HANDLE_NODES);
+    int* order = (int*) malloc(sizeof(int) * HANDLE_NODES);
+    for(int i = 0; i < HANDLE_NODES; i++)
+    {
+        order[i] = i;
+    }
+    shuffle(order, HANDLE_NODES);
+    for(int i = 0; i < HANDLE_NODES; i++)
+    { // handles[k] is the node of the item k
+        check(t, insertToRBTreeWithHandle(t, newInt(order[i]), &handles[order[i]]), "insertion with a handle failed");
+    }
+    for(int i = 0; i < HANDLE_NODES; i++)
+    {
+        check(t, RBTreeFind(t, &i) == handles[i], "RBTreeFind did not return the handle of the insertion");
+        int* equal = newInt(i);
+        check(t, RBTreeReplaceData(t, handles[i], equal) && handles[i]->data == equal,
+              "replacing the data of a handle failed");
+        int* other = newInt(i + 1);
+        check(t, !RBTreeReplaceData(t, handles[i], other), "replaced the data of a handle with a different item");
+        free(other);
+    }
+    shuffle(order, HANDLE_NODES);
+    for(int i = 0; i < HANDLE_NODES; i++)
+    { // deleting a node must not move the items of the other handles
+        check(t, deleteRBTreeNode(t, handles[order[i]]), "deletion of a handle failed");
+        check(t, isValidRBTree(t), "after the deletion of a handle, the tree is not valid");
+        check(t, !RBTreeContains(t, &order[i]), "a deleted handle is still in the tree");
+        if(i + 1 < HANDLE_NODES)
+        {
+            int next = order[i + 1];
+            check(t, RBTreeFind(t, &next) == handles[next] && *(int*)handles[next]->data == next,
+                  "a deletion changed the item of another handle");
+        }
+    }
+    check(t, t->size == 0, "deleted all the handles from the tree and yet the tree's size is not 0");
+    freeRBTree(&t);
+    free(handles);
+    free(order);
+    printf("\n\n*****passed the test of handles*****\n\n");
+}
+
+long comparisons = 0;
+
+int countingCompInt(const void* data1, const void* data2)
+{
+    comparisons++;
+    return compInt((void*) data1, (void*) data2);
+}
+
+void hintTree()
+{
+    // sorted items, each inserted next to the previous one (a NULL hint)
+    RBTree* t = newRBTree(&countingCompInt, &free);
+    comparisons = 0;
+    for(int i = 0; i < HINT_NODES; i++)
+    {
+        check(t, insertToRBTreeHint(t, newInt(i), NULL), "insertion with a hint failed");
+    }
+    check(t, isValidRBTree(t) && t->size == HINT_NODES, "after sorted insertions with a hint, the tree is not valid");
+    check(t, comparisons <= (long) MAX_HINT_COMPARISONS * HINT_NODES,
+          "sorted insertions with a hint did not take amortized O(1) comparisons");
+    printf("%d sorted insertions with a hint: %.2f comparisons per insertion\n", HINT_NODES,
+           (double) comparisons / HINT_NODES);
+    int duplicate = HINT_NODES / 2;
+    check(t, !insertToRBTreeHint(t, &duplicate, NULL), "inserted an item which is already in the tree");
+    freeRBTree(&t);
+
+    // random items, each inserted with the node of a random earlier item as a hint
+    t = newRBTree((CompareFunc) &compInt, &free);
+    Node** handles = (Node**) malloc(sizeof(Node*) * HANDLE_NODES);
+    int* a = (int*) malloc(sizeof(int) * HANDLE_NODES);
+    for(int i = 0; i < HANDLE_NODES; i++)
+    {
+        a[i] = i;
+    }
+    shuffle(a, HANDLE_NODES);
+    check(t, insertToRBTreeWithHandle(t, newInt(a[0]), &handles[0]), "insertion with a handle failed");
+    for(int i = 1; i < HANDLE_NODES; i++)
+    {
+        check(t, insertToRBTreeHint(t, newInt(a[i]), handles[rand() % i]), "insertion with a hint failed");
+        handles[i] = RBTreeFind(t, &a[i]);
+        check(t, isValidRBTree(t), "after an insertion with a hint, the tree is not valid");
+    }
+    for(int i = 0; i < HANDLE_NODES; i++)
+    {
+        check(t, RBTreeContains(t, &i), "an item inserted with a hint is not in the tree");
+    }
+    freeRBTree(&t);
+    free(handles);
+    free(a);
+    printf("\n\n*****passed the test of hinted insertions*****\n\n");
+}
+
+typedef struct Interval
+{
+    double low, high;
+    int id;
+} Interval;
+
+int compInterval(const void* data1, const void* data2)
+{
+    const Interval* a = (const Interval*) data1;
+    const Interval* b = (const Interval*) data2;
+    if(a->low != b->low)
+        return a->low < b->low ? -1 : 1;
+    if(a->high != b->high)
+        return a->high < b->high ? -1 : 1;
+    return a->id - b->id;
+}
+
+double intervalLow(const void* data)
+{
+    return ((const Interval*) data)->low;
+}
+
+double intervalHigh(const void* data)
+{
+    return ((const Interval*) data)->high;
+}
+
+typedef struct OverlapQuery
+{
+    double low, high;
+    int count;
+    const Interval* last;
+    bool failed;
+} OverlapQuery;
+
+int countOverlap(const void* data, void* args)
+{
+    const Interval* interval = (const Interval*) data;
+    OverlapQuery* query = (OverlapQuery*) args;
+    if(interval->low > query->high || interval->high < query->low ||
+       (query->last != NULL && compInterval(query->last, interval) >= 0))
+    { // not overlapping, or not in an ascending order
+        query->failed = true;
+    }
+    query->last = interval;
+    query->count++;
+    return 1;
+}
+
+void checkOverlaps(RBTree* t, Interval** a, const bool* inTree, const int n)
+{
+    for(int q = 0; q < INTERVAL_QUERIES; q++)
+    {
+        OverlapQuery query = {rand() % MAX_INTERVAL_VALUE, 0, 0, NULL, false};
+        query.high = query.low + rand() % MAX_INTERVAL_LENGTH;
+        int expected = 0;
+        for(int i = 0; i < n; i++)
+        {
+            expected += inTree[i] && a[i]->low <= query.high && a[i]->high >= query.low;
+        }
+        check(t, forEachOverlappingRBTree(t, query.low, query.high, &countOverlap, &query),
+              "an overlap query failed");
+        check(t, !query.failed, "an overlap query visited a non overlapping item, or not in an ascending order");
+        check(t, query.count == expected, "an overlap query missed an overlapping item");
+    }
+}
+
+void intervalTree()
+{
+    RBTree* t = newIntervalRBTree(&compInterval, &free, &intervalLow, &intervalHigh);
+    Interval** a = (Interval**) malloc(sizeof(Interval*) * INTERVAL_NODES);
+    bool* inTree = (bool*) malloc(sizeof(bool) * INTERVAL_NODES);
+    for(int i = 0; i < INTERVAL_NODES; i++)
+    {
+        a[i] = (Interval*) malloc(sizeof(Interval));
+        a[i]->low = rand() % MAX_INTERVAL_VALUE;
+        a[i]->high = a[i]->low + rand() % MAX_INTERVAL_LENGTH;
+        a[i]->id = i;
+        check(t, insertToRBTree(t, a[i]), "insertion of an interval failed");
+        inTree[i] = true;
+    }
+    check(t, isValidRBTree(t), "after the insertion of the intervals, the tree is not valid");
+    checkOverlaps(t, a, inTree, INTERVAL_NODES);
+
+    for(int i = 0; i < INTERVAL_NODES; i += 2)
+    { // the deletions and rotations must keep the subtree maxima of the endpoints
+        Interval key = *a[i];
+        check(t, deleteFromRBTree(t, &key), "deletion of an interval failed");
+        inTree[i] = false;
+    }
+    check(t, isValidRBTree(t), "after the deletion of the intervals, the tree is not valid");
+    checkOverlaps(t, a, inTree, INTERVAL_NODES);
+
+    RBTree* plain = newRBTree((CompareFunc) &compInt, &free);
+    check(plain, !forEachOverlappingRBTree(plain, 0, 1, &countOverlap, NULL),
+          "an overlap query succeeded on a tree which is not an interval tree");
+    freeRBTree(&plain);
+    freeRBTree(&t);
+    free(a);
+    free(inTree);
+    printf("\n\n*****passed the test of interval trees*****\n\n");
+}
+
+typedef struct AscendingItems
+{
+    int count, last;
+} AscendingItems;
+
+int countAscending(const void* data, void* args)
+{
+    AscendingItems* items = (AscendingItems*) args;
+    if(items->count > 0 && *(const int*) data <= items->last)
+    {
+        return 0;
+    }
+    items->last = *(const int*) data;
+    items->count++;
+    return 1;
+}
+
+void lazyTree()
+{
+    RBTree* t = newRBTree((CompareFunc) &compInt, &free);
+    check(t, setRBTreeLazyDeletion(t, MAX_DEAD_RATIO), "setting lazy deletion failed");
+    check(t, !setRBTreeLazyDeletion(t, 1), "set a dead ratio of 1");
+    int* a = (int*) malloc(sizeof(int) * LAZY_NODES);
+    bool* inTree = (bool*) calloc(LAZY_NODES, sizeof(bool));
+    for(int i = 0; i < LAZY_NODES; i++)
+    {
+        a[i] = i;
+    }
+    shuffle(a, LAZY_NODES);
+    long unsigned size = 0;
+    bool compacted = false;
+    for(int i = 0; i < 4 * LAZY_NODES; i++)
+    { // random insertions (which revive dead nodes) and deletions (which only mark them until compaction)
+        int k = a[rand() % LAZY_NODES];
+        if(inTree[k])
+        {
+            long unsigned dead = t->deadCount;
+            check(t, deleteFromRBTree(t, &k), "lazy deletion failed");
+            compacted = compacted || t->deadCount < dead;
+            size--;
+        }
+        else
+        {
+            check(t, insertToRBTree(t, newInt(k)), "insertion into a lazily deleting tree failed");
+            size++;
+        }
+        inTree[k] = !inTree[k];
+        check(t, t->size == size, "the tree's size does not count only the live items");
+        check(t, RBTreeContains(t, &k) == inTree[k], "RBTreeContains differs for a lazily deleted item");
+        check(t, t->deadCount <= MAX_DEAD_RATIO * (double) (t->size + t->deadCount),
+              "the dead nodes passed the ratio and the tree was not compacted");
+    }
+    check(t, compacted, "the tree was never compacted");
+    check(t, isValidRBTree(t), "after lazy deletions, the tree is not valid");
+    AscendingItems items = {0, 0};
+    check(t, forEachRBTree(t, &countAscending, &items) && items.count == (int) size,
+          "forEachRBTree did not skip the lazily deleted items");
+
+    check(t, compactRBTree(t) && t->deadCount == 0, "compaction failed");
+    check(t, isValidRBTree(t) && t->size == size, "after compaction, the tree is not valid");
+    items.count = 0;
+    check(t, forEachRBTree(t, &countAscending, &items) && items.count == (int) size,
+          "after compaction, forEachRBTree differs");
+    for(int k = 0; k < LAZY_NODES; k++)
+    {
+        check(t, RBTreeContains(t, &k) == inTree[k], "after compaction, RBTreeContains differs");
+    }
+
+    // back to eager deletion, which compacts the dead nodes first
+    int k = 0;
+    while(!inTree[k])
+    {
+        k++;
+    }
+    check(t, deleteFromRBTree(t, &k) && t->deadCount == 1, "lazy deletion failed");
+    check(t, setRBTreeLazyDeletion(t, 0) && t->deadCount == 0, "setting eager deletion did not compact the tree");
+    check(t, isValidRBTree(t), "after setting eager deletion, the tree is not valid");
+    freeRBTree(&t);
+    free(a);
+    free(inTree);
+    printf("\n\n*****passed the test of lazy deletion*****\n\n");
+}
+
+size_t stringSize(const void* data)
+{
+    return strlen((const char*) data) + 1;
+}
+
+void checkMemory(RBTree* t)
+{
+    RBTreeMemory usage = RBTreeMemoryUsage(t, &stringSize);
+    check(t, t->memoryUsage == usage.totalBytes, "the running memory total differs from RBTreeMemoryUsage");
+    check(t, usage.nodeCount == t->size + t->deadCount, "RBTreeMemoryUsage did not count all the nodes");
+    check(t, usage.totalBytes == usage.treeBytes + usage.nodeBytes + usage.payloadBytes + usage.slackBytes,
+          "the memory total is not the sum of its parts");
+}
+
+void memoryTree()
+{
+    RBTree* t = newRBTree((CompareFunc) &stringCompare, (FreeFunc) &freeString);
+    check(t, trackRBTreeMemory(t, &stringSize), "tracking the memory of the tree failed");
+    checkMemory(t);
+    RBTreeMemory empty = RBTreeMemoryUsage(t, &stringSize);
+    char** a = (char**) malloc(sizeof(char*) * MEMORY_NODES);
+    size_t payload = 0;
+    for(int i = 0; i < MEMORY_NODES; i++)
+    {
+        a[i] = randomString(MAX_STRING_LENGTH_CHECK);
+        if(insertToRBTree(t, a[i]))
+        {
+            payload += stringSize(a[i]);
+        }
+        else
+        { // a duplicate string
+            free(a[i]);
+            a[i] = NULL;
+        }
+        checkMemory(t);
+    }
+    RBTreeMemory usage = RBTreeMemoryUsage(t, &stringSize);
+    check(t, usage.payloadBytes == payload && usage.nodeBytes == t->size * sizeof(Node),
+          "RBTreeMemoryUsage did not measure the nodes and the items");
+    printf("%lu strings: %lu bytes (%lu of nodes, %lu of strings, %lu of slack)\n", t->size,
+           (long unsigned) usage.totalBytes, (long unsigned) usage.nodeBytes, (long unsigned) usage.payloadBytes,
+           (long unsigned) usage.slackBytes);
+
+    for(int i = 0; i < MEMORY_NODES; i += 2)
+    { // replacing an item with an equal one, in a new allocation
+        if(a[i] != NULL)
+        {
+            char* copy = (char*) malloc(stringSize(a[i]));
+            strcpy(copy, a[i]);
+            check(t, RBTreeReplaceData(t, RBTreeFind(t, copy), copy), "replacing an item failed");
+            a[i] = copy;
+            checkMemory(t);
+        }
+    }
+    check(t, setRBTreeLazyDeletion(t, MAX_DEAD_RATIO), "setting lazy deletion failed");
+    for(int i = 0; i < MEMORY_NODES; i++)
+    { // lazy deletions keep the memory of the dead nodes until compaction
+        if(a[i] != NULL)
+        {
+            check(t, deleteFromRBTree(t, a[i]), "deletion failed");
+            checkMemory(t);
+        }
+    }
+    check(t, t->size == 0 && t->deadCount == 0 && t->memoryUsage == empty.totalBytes,
+          "after deleting all the items, the memory of the tree is not the memory of an empty tree");
+    check(t, trackRBTreeMemory(t, NULL) && t->memoryUsage == 0, "stopping the memory tracking failed");
+    freeRBTree(&t);
+    free(a);
+    printf("\n\n*****passed the test of memory accounting*****\n\n");
+}
+
+int serializeInt(const void* data, FILE* out)
+{
+    return fwrite(data, sizeof(int), 1, out) == 1;
+}
+
+void* deserializeInt(FILE* in)
+{
+    int* toReturn = (int*) malloc(sizeof(int));
+    if(fread(toReturn, sizeof(int), 1, in) != 1)
+    {
+        free(toReturn);
+        return NULL;
+    }
+    return toReturn;
+}
+
+long fileSize(const char* path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (long) st.st_size : -1;
+}
+
+void checkMembers(RBTree* t, const bool* expected, const int n, const char* message)
+{
+    long unsigned size = 0;
+    for(int k = 0; k < n; k++)
+    {
+        size += expected[k];
+        check(t, RBTreeContains(t, &k) == expected[k], message);
+    }
+    check(t, t->size == size && isValidRBTree(t), message);
+}
+
+RBTree* recoverWal()
+{
+    RBTree* t = newRBTree((CompareFunc) &compInt, &free);
+    check(t, recoverRBTree(t, WAL_SNAPSHOT, WAL_LOG, &deserializeInt), "recovery failed");
+    return t;
+}
+
+void walTree()
+{
+    remove(WAL_SNAPSHOT);
+    remove(WAL_LOG);
+    bool* expected = (bool*) calloc(WAL_KEYS + 2, sizeof(bool));
+    RBTree* t = newRBTree((CompareFunc) &compInt, &free);
+    RBTreeLog* log = openRBTreeLog(WAL_LOG, &serializeInt, WAL_COMMIT_INTERVAL);
+    check(t, log != NULL && setRBTreeLog(t, log), "opening the log failed");
+    for(int i = 0; i < WAL_OPERATIONS; i++)
+    { // random insertions, deletions and updates, with a checkpoint in the middle
+        int k = rand() % WAL_KEYS;
+        if(expected[k] && rand() % 4 == 0)
+        {
+            check(t, RBTreeReplaceData(t, RBTreeFind(t, &k), newInt(k)), "a logged update failed");
+        }
+        else
+        {
+            check(t, expected[k] ? deleteFromRBTree(t, &k) : insertToRBTree(t, newInt(k)), "a logged operation failed");
+            expected[k] = !expected[k];
+        }
+        if(i == WAL_OPERATIONS / 2)
+        {
+            check(t, checkpointRBTree(t, WAL_SNAPSHOT) && fileSize(WAL_LOG) == 0,
+                  "the checkpoint did not empty the log");
+        }
+    }
+    int last = WAL_KEYS;
+    check(t, insertToRBTree(t, newInt(last)), "a logged operation failed");
+    expected[last] = true;
+    closeRBTreeLog(&log);
+    freeRBTree(&t);
+
+    // the snapshot, and the records which followed it
+    t = recoverWal();
+    checkMembers(t, expected, WAL_KEYS + 2, "the recovered tree differs from the logged tree");
+    freeRBTree(&t);
+
+    // a crash in the middle of the last record - only that record is lost, and the tear is cut off the log
+    long size = fileSize(WAL_LOG);
+    check(NULL, truncate(WAL_LOG, size - WAL_TORN_BYTES) == 0, "tearing the log failed");
+    t = recoverWal();
+    expected[last] = false;
+    checkMembers(t, expected, WAL_KEYS + 2, "the recovery of a torn log did not drop exactly the torn record");
+    check(t, fileSize(WAL_LOG) < size - WAL_TORN_BYTES, "the recovery did not truncate the torn record");
+
+    // a record appended after the recovery is replayed by the next recovery
+    log = openRBTreeLog(WAL_LOG, &serializeInt, WAL_COMMIT_INTERVAL);
+    check(t, log != NULL && setRBTreeLog(t, log), "opening the log failed");
+    int appended = WAL_KEYS + 1;
+    check(t, insertToRBTree(t, newInt(appended)), "an append after the recovery failed");
+    expected[appended] = true;
+    closeRBTreeLog(&log);
+    freeRBTree(&t);
+    t = recoverWal();
+    checkMembers(t, expected, WAL_KEYS + 2, "a record appended after the recovery was lost");
+    freeRBTree(&t);
+
+    free(expected);
+    remove(WAL_SNAPSHOT);
+    remove(WAL_LOG);
+    printf("\n\n*****passed the test of the write-ahead log*****\n\n");
+}
+
+typedef struct CollectedItems
+{
+    int* items;
+    int count;
+} CollectedItems;
+
+int collectItem(const void* data, void* args)
+{
+    CollectedItems* collected = (CollectedItems*) args;
+    collected->items[collected->count++] = *(const int*) data;
+    return 1;
+}
+
+void checkFrozen(RBTree* t, FrozenRBTree* f, const bool* present, const bool isInline)
+{
+    // nextKey[q] - the smallest key which is not smaller than q, FROZEN_MAX_KEY if there is none
+    int nextKey[FROZEN_MAX_KEY + 2];
+    nextKey[FROZEN_MAX_KEY + 1] = FROZEN_MAX_KEY;
+    for(int q = FROZEN_MAX_KEY; q >= 0; q--)
+    {
+        nextKey[q] = (q < FROZEN_MAX_KEY && present[q]) ? q : nextKey[q + 1];
+    }
+    for(int q = -1; q <= FROZEN_MAX_KEY; q++)
+    {
+        int expected = nextKey[q < 0 ? 0 : q];
+        check(t, frozenRBTreeContains(f, &q) == (q >= 0 && q < FROZEN_MAX_KEY && present[q]),
+              "contains of a snapshot differs from the tree");
+        int* bound = (int*) frozenRBTreeLowerBound(f, &q);
+        check(t, (bound == NULL) == (expected == FROZEN_MAX_KEY), "lower bound of a snapshot differs from the tree");
+        if(bound != NULL)
+        {
+            check(t, *bound == expected, "lower bound of a snapshot differs from the tree");
+            check(t, (bound == RBTreeFind(t, bound)->data) == !isInline,
+                  "a snapshot does not return the items (or the copies) it should");
+        }
+    }
+
+    int items[FROZEN_MAX_SIZE];
+    CollectedItems collected = {items, 0};
+    for(int r = 0; r < FROZEN_RANGES; r++)
+    {
+        int low = rand() % (FROZEN_MAX_KEY + 2) - 1, high = rand() % (FROZEN_MAX_KEY + 2) - 1;
+        collected.count = 0;
+        check(t, forEachFrozenRBTreeRange(f, &low, &high, &collectItem, &collected), "range of a snapshot failed");
+        int count = 0;
+        for(int k = (low < 0 ? 0 : low); k <= high && k < FROZEN_MAX_KEY; k++)
+        {
+            if(present[k])
+            {
+                check(t, count < collected.count && items[count] == k, "range of a snapshot differs from the tree");
+                count++;
+            }
+        }
+        check(t, count == collected.count, "range of a snapshot differs from the tree");
+    }
+}
+
+void frozenTree()
+{
+    int keys[FROZEN_MAX_KEY];
+    bool present[FROZEN_MAX_KEY];
+    for(int n = 0; n <= FROZEN_MAX_SIZE; n++)
+    {
+        for(int k = 0; k < FROZEN_MAX_KEY; k++)
+        {
+            keys[k] = k;
+            present[k] = false;
+        }
+        shuffle(keys, FROZEN_MAX_KEY);
+        RBTree* t = newRBTree((CompareFunc) &compInt, &free);
+        for(int i = 0; i < n; i++)
+        {
+            check(t, insertToRBTree(t, newInt(keys[i])), "insertion failed");
+            present[keys[i]] = true;
+        }
+        for(int isInline = 0; isInline <= 1; isInline++)
+        {
+            FrozenRBTree* f = isInline ? RBTreeFreezeInline(t, sizeof(int)) : RBTreeFreeze(t);
+            check(t, f != NULL && f->size == (long unsigned) n, "freezing failed");
+            checkFrozen(t, f, present, isInline);
+            freeFrozenRBTree(&f);
+        }
+        freeRBTree(&t);
+    }
+    printf("\n\n*****passed the test of frozen snapshots*****\n\n");
+}
+
+typedef struct IntItem
+{
+    int value;
+    RBLink link;
+} IntItem;
+
+int compIntLinks(const RBLink* a, const RBLink* b)
+{
+    return compInt(&RB_CONTAINER_OF(a, IntItem, link)->value, &RB_CONTAINER_OF(b, IntItem, link)->value);
+}
+
+void freeIntLink(RBLink* link)
+{
+    free(RB_CONTAINER_OF(link, IntItem, link));
+}
+
+int countAscendingLinks(const RBLink* link, void* args)
+{
+    return countAscending(&RB_CONTAINER_OF(link, IntItem, link)->value, args);
+}
+
+int intrusiveBlackHeight(const IntrusiveRBTree* t, const RBLink* link, const RBLink* parent)
+{ // the black height of a valid subtree, -1 if the subtree is not valid
+    if(link == NULL)
+    {
+        return 1;
+    }
+    if(link->parent != parent ||
+       (link->color == RED && ((link->left != NULL && link->left->color == RED) ||
+                               (link->right != NULL && link->right->color == RED))) ||
+       (link->left != NULL && t->compFunc(link->left, link) >= 0) ||
+       (link->right != NULL && t->compFunc(link->right, link) <= 0))
+    {
+        return -1;
+    }
+    int left = intrusiveBlackHeight(t, link->left, link), right = intrusiveBlackHeight(t, link->right, link);
+    if(left == -1 || left != right)
+    {
+        return -1;
+    }
+    return left + (link->color == BLACK);
+}
+
+bool isValidIntrusiveRBTree(const IntrusiveRBTree* t)
+{
+    AscendingItems items = {0, 0};
+    return (t->root == NULL || t->root->color == BLACK) && intrusiveBlackHeight(t, t->root, NULL) != -1 &&
+           forEachIntrusiveRBTree(t, &countAscendingLinks, &items) && (long unsigned) items.count == t->size;
+}
+
+void checkIntrusive(IntrusiveRBTree* t, const bool condition, const char* message)
+{
+    if(!condition)
+    {
+        printf("ERROR - %s\n", message);
+        freeIntrusiveRBTree(&t);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void intrusiveTree()
+{
+    // the items are not owned by the tree - random insertions, searches and removals against a reference
+    IntItem* items = (IntItem*) malloc(sizeof(IntItem) * INTRUSIVE_KEYS);
+    bool* inTree = (bool*) calloc(INTRUSIVE_KEYS, sizeof(bool));
+    IntrusiveRBTree* t = newIntrusiveRBTree(&compIntLinks, NULL);
+    for(int k = 0; k < INTRUSIVE_KEYS; k++)
+    {
+        items[k].value = k;
+    }
+    for(int i = 0; i < INTRUSIVE_OPERATIONS; i++)
+    {
+        int k = rand() % INTRUSIVE_KEYS;
+        IntItem key = {k, {NULL, NULL, NULL, RED}};
+        RBLink* found = findInIntrusiveRBTree(t, &key.link);
+        checkIntrusive(t, found == (inTree[k] ? &items[k].link : NULL), "find differs from the reference");
+        checkIntrusive(t, !intrusiveRBTreeContains(t, &key.link) == !inTree[k], "contains differs from the reference");
+        if(!inTree[k])
+        {
+            checkIntrusive(t, insertToIntrusiveRBTree(t, &items[k].link), "insertion failed");
+        }
+        else if(rand() % 2)
+        {
+            checkIntrusive(t, removeFromIntrusiveRBTree(t, found), "removal failed");
+        }
+        else
+        {
+            checkIntrusive(t, deleteFromIntrusiveRBTree(t, &key.link), "deletion failed");
+        }
+        inTree[k] = !inTree[k];
+        checkIntrusive(t, isValidIntrusiveRBTree(t), "after an insertion or a removal, the tree is not valid");
+    }
+    int absent = INTRUSIVE_KEYS;
+    IntItem absentKey = {absent, {NULL, NULL, NULL, RED}};
+    checkIntrusive(t, !deleteFromIntrusiveRBTree(t, &absentKey.link), "deleted a key which is not in the tree");
+    for(int k = 0; k < INTRUSIVE_KEYS; k++)
+    {
+        checkIntrusive(t, !inTree[k] || !insertToIntrusiveRBTree(t, &items[k].link),
+                       "inserted an item which is already in the tree");
+    }
+    freeIntrusiveRBTree(&t);
+    free(items);
+    free(inTree);
+
+    // the items are owned by the tree - deleted and freed items are released by the tree
+    t = newIntrusiveRBTree(&compIntLinks, &freeIntLink);
+    for(int k = 0; k < INTRUSIVE_OWNED_ITEMS; k++)
+    {
+        IntItem* item = (IntItem*) malloc(sizeof(IntItem));
+        item->value = k;
+        checkIntrusive(t, insertToIntrusiveRBTree(t, &item->link), "insertion failed");
+    }
+    for(int k = 0; k < INTRUSIVE_OWNED_ITEMS; k += 2)
+    {
+        IntItem key = {k, {NULL, NULL, NULL, RED}};
+        checkIntrusive(t, deleteFromIntrusiveRBTree(t, &key.link), "deletion failed");
+    }
+    checkIntrusive(t, isValidIntrusiveRBTree(t) && t->size == INTRUSIVE_OWNED_ITEMS / 2,
+                   "after the deletions, the tree is not valid");
+    freeIntrusiveRBTree(&t);
+    printf("\n\n*****passed the test of intrusive trees*****\n\n");
+}
+
 int main()
 {
     srand(time(0));
+    handleTree();
+    hintTree();
+    intervalTree();
+    lazyTree();
+    memoryTree();
+    walTree();
+    frozenTree();
+    intrusiveTree();
     //intTree();
     stringTree();
     vectorTree();
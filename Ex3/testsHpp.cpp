@@ -0,0 +1,289 @@
+/**
+ * @file testsHpp.cpp
+ * @author Ron Shuvy
+ * @brief tests of the header-only rbtree::RBTree: random operations checked against std::set, the number of
+ *        comparator calls of a lookup, and a benchmark of string keys against std::set. the random operations and
+ *        the benchmark also run on the void* RBTree of RBTree.h, which the template replaces.
+ */
+// ------------------------------ includes ------------------------------
+#include "RBTree.hpp"
+extern "C"
+{
+#include "RBTree.h"
+}
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+// -------------------------- const definitions -------------------------
+#define RANDOM_OPERATIONS 200000
+#define MAX_INT_VALUE_CHECK 5000
+#define COUNTED_ITEMS 100000
+#define BENCH_STRINGS 250000
+#define BENCH_STRING_LENGTH 24
+// ------------------------------ functions -----------------------------
+
+/**
+ * @brief a comparator which counts its calls
+ */
+struct CountingLess
+{
+    long *calls;
+    bool operator()(int a, int b) const
+    {
+        ++*calls;
+        return a < b;
+    }
+};
+
+/**
+ * @brief exits with a message if a condition does not hold
+ */
+void check(bool condition, const char *message)
+{
+    if (!condition)
+    {
+        printf("ERROR - %s\n", message);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief compares two int items of the void* RBTree
+ */
+int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief appends an int item of the void* RBTree to a vector
+ */
+int appendInt(const void *item, void *items)
+{
+    ((std::vector<int> *)items)->push_back(*(const int *)item);
+    return 1;
+}
+
+/**
+ * @brief adapts the void* RBTree of ints (each item a separate allocation) to the members used by
+ *        randomOperations
+ */
+class VoidIntTree
+{
+private:
+    ::RBTree *_tree;
+
+public:
+    VoidIntTree() : _tree(newRBTree(compareInts, free)) { check(_tree != nullptr, "newRBTree failed"); }
+    ~VoidIntTree() { freeRBTree(&_tree); }
+    VoidIntTree(const VoidIntTree &) = delete;
+    VoidIntTree &operator=(const VoidIntTree &) = delete;
+
+    bool insert(int val)
+    {
+        int *item = (int *)malloc(sizeof(int));
+        check(item != nullptr, "malloc failed");
+        *item = val;
+        if (!insertToRBTree(_tree, item))
+        {
+            free(item);
+            return false;
+        }
+        return true;
+    }
+    bool erase(int val) { return deleteFromRBTree(_tree, &val) != 0; }
+    bool contains(int val) const { return RBTreeContains(_tree, &val) != 0; }
+    size_t size() const { return _tree->size; }
+    std::vector<int> items() const
+    {
+        std::vector<int> items;
+        forEachRBTree(_tree, appendInt, &items);
+        return items;
+    }
+};
+
+/**
+ * @brief the items of an rbtree::RBTree, in order
+ */
+std::vector<int> treeItems(const rbtree::RBTree<int> &tree)
+{
+    std::vector<int> items;
+    tree.forEach([&items](int val) { items.push_back(val); return true; });
+    return items;
+}
+
+/**
+ * @brief the items of a VoidIntTree, in order
+ */
+std::vector<int> treeItems(const VoidIntTree &tree)
+{
+    return tree.items();
+}
+
+/**
+ * @brief random insertions, deletions and lookups, with the same results as std::set. prints the time of the
+ *        operations (including the checks against std::set).
+ */
+template <class Tree>
+void randomOperations(const char *name)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::mt19937 random(0);
+    Tree tree;
+    std::set<int> expected;
+    for (int i = 0; i < RANDOM_OPERATIONS; ++i)
+    {
+        int val = (int)(random() % MAX_INT_VALUE_CHECK);
+        switch (random() % 3)
+        {
+            case 0:
+                check(tree.insert(val) == expected.insert(val).second, "insert differs from std::set");
+                break;
+            case 1:
+                check(tree.erase(val) == (expected.erase(val) == 1), "erase differs from std::set");
+                break;
+            default:
+                check(tree.contains(val) == (expected.count(val) == 1), "contains differs from std::set");
+        }
+        check(tree.size() == expected.size(), "size differs from std::set");
+    }
+    check(treeItems(tree) == std::vector<int>(expected.begin(), expected.end()), "forEach order differs from std::set");
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("passed random operations of %s (%.3fs)\n", name, elapsed.count());
+}
+
+/**
+ * @brief a lookup calls the comparator once per level, and once more for the equivalence check
+ */
+void comparisonCount()
+{
+    long calls = 0;
+    rbtree::RBTree<int, CountingLess> tree(CountingLess{&calls});
+    for (int i = 0; i < COUNTED_ITEMS; ++i)
+    {
+        tree.insert(i);
+    }
+    // a red-black tree of n nodes is at most 2 * log2(n + 1) levels deep
+    long maxCalls = (long)(2 * std::log2(COUNTED_ITEMS + 1.0)) + 1;
+    for (int i = -1; i <= COUNTED_ITEMS; ++i)
+    {
+        calls = 0;
+        check(tree.contains(i) == (i >= 0 && i < COUNTED_ITEMS), "contains failed");
+        check(calls <= maxCalls, "a lookup called the comparator more than once per level");
+    }
+    printf("passed comparison count (at most %ld calls per lookup)\n", maxCalls);
+}
+
+/**
+ * @brief the time of inserting and then finding all of the given strings, in seconds
+ */
+template <class Set>
+double insertAndFind(const std::vector<std::string> &strings, Set &set)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string &s : strings)
+    {
+        set.insert(s);
+    }
+    size_t found = 0;
+    for (const std::string &s : strings)
+    {
+        found += set.count(s);
+    }
+    check(found == strings.size(), "a string was not found");
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/**
+ * @brief adapts rbtree::RBTree to the std::set members used by insertAndFind
+ */
+struct StringTree
+{
+    rbtree::RBTree<std::string> tree;
+    void insert(const std::string &s) { tree.insert(s); }
+    size_t count(const std::string &s) const { return tree.contains(s) ? 1 : 0; }
+};
+
+/**
+ * @brief compares two std::string items of the void* RBTree
+ */
+int compareStrings(const void *a, const void *b)
+{
+    return ((const std::string *)a)->compare(*(const std::string *)b);
+}
+
+/**
+ * @brief frees a std::string item of the void* RBTree
+ */
+void freeString(void *s)
+{
+    delete (std::string *)s;
+}
+
+/**
+ * @brief adapts the void* RBTree of strings (each item a separate allocation) to the std::set members used by
+ *        insertAndFind
+ */
+class VoidStringTree
+{
+private:
+    ::RBTree *_tree;
+
+public:
+    VoidStringTree() : _tree(newRBTree(compareStrings, freeString)) { check(_tree != nullptr, "newRBTree failed"); }
+    ~VoidStringTree() { freeRBTree(&_tree); }
+    VoidStringTree(const VoidStringTree &) = delete;
+    VoidStringTree &operator=(const VoidStringTree &) = delete;
+
+    void insert(const std::string &s)
+    {
+        std::string *item = new std::string(s);
+        if (!insertToRBTree(_tree, item))
+        {
+            delete item;
+        }
+    }
+    size_t count(const std::string &s) const { return RBTreeContains(_tree, &s) ? 1 : 0; }
+};
+
+/**
+ * @brief string keys with a long common prefix, so every comparison is expensive
+ */
+void stringBenchmark()
+{
+    std::mt19937 random(0);
+    std::vector<std::string> strings;
+    for (int i = 0; i < BENCH_STRINGS; ++i)
+    {
+        std::string s(BENCH_STRING_LENGTH, 'k');
+        s += std::to_string(random());
+        strings.push_back(s);
+    }
+    StringTree tree;
+    VoidStringTree voidTree;
+    std::set<std::string> set;
+    double treeTime = insertAndFind(strings, tree), voidTime = insertAndFind(strings, voidTree);
+    double setTime = insertAndFind(strings, set);
+    printf("%d strings, insert + find: rbtree::RBTree %.3fs, void* RBTree %.3fs, std::set %.3fs\n", BENCH_STRINGS,
+           treeTime, voidTime, setTime);
+}
+
+/**
+ * Program's main
+ */
+int main()
+{
+    randomOperations<rbtree::RBTree<int>>("rbtree::RBTree");
+    randomOperations<VoidIntTree>("the void* RBTree");
+    comparisonCount();
+    stringBenchmark();
+    printf("\nPassed All tests!!\n");
+    return EXIT_SUCCESS;
+}
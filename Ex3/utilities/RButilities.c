@@ -138,9 +138,9 @@ int isValidRBTree(RBTree *tree)
 			fprintf(stderr, "Double pointers aren't matching\n");
 			return 0;
 		}
-		if (treeSize(tree->root, 0) != (int)tree->size)
+		if (treeSize(tree->root, 0) != (int)(tree->size + tree->deadCount))
 		{
-			fprintf(stderr, "%d - %d \n", treeSize(tree->root, 0), (int)tree->size);
+			fprintf(stderr, "%d - %d \n", treeSize(tree->root, 0), (int)(tree->size + tree->deadCount));
 			fprintf(stderr, "Calculated tree size and tree.size property are different.\n");
 			return 0;
 		}
@@ -252,7 +252,7 @@ int RBTreeToJSON(RBTree *tree, char *filename, char* (*toString)(void*))
 	FILE *json = fopen(filename, "w");
 	assert(json != NULL && "failed file open");
 
-	size_t bufferSize = tree->size * (256 * sizeof(char));
+	size_t bufferSize = (tree->size + tree->deadCount) * (256 * sizeof(char));
 	char *buffer = (char*)calloc(bufferSize, sizeof(char));
 	assert(buffer != NULL && "failed alloc");
 
@@ -24,35 +24,57 @@ Activation::Activation(ActivationType actType)
 }
 
 /**
- * @fn Relu activation function
+ * @fn Relu activation function (in place)
  */
-Matrix Activation::_relu(const Matrix& mat) const
+void Activation::_relu(Matrix& mat) const
 {
-    Matrix r(mat.getRows(), mat.getCols());
+    float *data = mat.getData();
     for (int i = 0; i < mat.getRows() * mat.getCols(); ++i)
     {
-        r[i] = (mat[i] >= 0) ? mat[i] : 0;
+        data[i] = (data[i] >= 0) ? data[i] : 0;
     }
-    return r;
 }
 
 /**
- * @fn Softmax activation function
+ * @fn Softmax activation function (in place)
  */
-Matrix Activation::_softmax(const Matrix& mat) const
+void Activation::_softmax(Matrix& mat) const
 {
+    float *data = mat.getData();
     float sum = 0;
     for (int k = 0; k < mat.getRows() * mat.getCols(); ++k)
     {
-        sum += (float)std::exp(mat[k]);
+        data[k] = (float)std::exp(data[k]);
+        sum += data[k];
     }
 
-    Matrix r(mat.getRows(), mat.getCols());
     for (int i = 0; i < mat.getRows() * mat.getCols(); ++i)
     {
-        r[i] = (float)std::exp(mat[i]) * (1 / sum);
+        data[i] = data[i] * (1 / sum);
+    }
+}
+
+/**
+ * @fn Softmax activation function of each column (in place)
+ */
+void Activation::_softmaxColumns(Matrix& mat) const
+{
+    float *data = mat.getData();
+    int rows = mat.getRows(), cols = mat.getCols();
+    for (int j = 0; j < cols; ++j)
+    {
+        float sum = 0;
+        for (int k = 0; k < rows; ++k)
+        {
+            data[k * cols + j] = (float)std::exp(data[k * cols + j]);
+            sum += data[k * cols + j];
+        }
+
+        for (int i = 0; i < rows; ++i)
+        {
+            data[i * cols + j] = data[i * cols + j] * (1 / sum);
+        }
     }
-    return r;
 }
 
 
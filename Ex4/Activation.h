@@ -29,8 +29,9 @@ class Activation
 {
 private:
     ActivationType _type; // activation type
-    Matrix _relu(const Matrix& mat) const; // Relu function
-    Matrix _softmax(const Matrix& mat) const; // Softmax function
+    void _relu(Matrix& mat) const; // Relu function (in place)
+    void _softmax(Matrix& mat) const; // Softmax function (in place)
+    void _softmaxColumns(Matrix& mat) const; // Softmax function of each column (in place)
 
 public:
     /**
@@ -43,11 +44,40 @@ public:
     */
     ActivationType getActivationType() const { return _type; }
 
+    /**
+    * @fn apply
+    * @brief calls the relevant activation function on a matrix, in place
+    */
+    void apply(Matrix &mat) const { (_type == Relu) ? _relu(mat) : _softmax(mat); }
+
+    /**
+    * @fn applyToColumns
+    * @brief calls the relevant activation function on each column of a matrix (a batch of inputs), in place
+    */
+    void applyToColumns(Matrix &mat) const { (_type == Relu) ? _relu(mat) : _softmaxColumns(mat); }
+
     /**
     * @fn operator ()
     * @brief this operator calls the relevant activation function on a matrix input
     */
-    Matrix operator()(const Matrix &mat) const { return (_type == Relu) ? _relu(mat) : _softmax(mat); }
+    Matrix operator()(const Matrix &mat) const
+    {
+        Matrix r = mat;
+        apply(r);
+        return r;
+    }
+
+    /**
+    * @fn operator ()
+    * @brief as operator()(mat), with the result in a matrix of a workspace (see Matrix(rows, cols, workspace))
+    */
+    Matrix operator()(const Matrix &mat, Workspace &workspace) const
+    {
+        Matrix r(mat.getRows(), mat.getCols(), workspace);
+        r = mat; // of the same size, so it is copied into the elements of the workspace
+        apply(r);
+        return r;
+    }
 };
 
 #endif //ACTIVATION_H
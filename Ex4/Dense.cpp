@@ -6,13 +6,179 @@
 
 // ------------------------------ includes ------------------------------
 #include "Dense.h"
+#include <algorithm>
+// -------------------------- const definitions -------------------------
+#define ERROR_DENSE_MULT "Error: Illegal matrix multiplication."
 // ------------------------------ method definitions -----------------------------
 
 /**
  * @fn This function calculates the result of the current Dense
  */
-Matrix Dense::operator()(const Matrix &x)
+Matrix Dense::operator()(const Matrix &x) const
 {
-    Matrix z = (_weights * x) + _bias;
-    return _act(z);
+    Matrix z(_rows, x.getCols());
+    apply(x, z);
+    return z;
+}
+
+/**
+ * @fn This function calculates the result of the current Dense into a matrix of a workspace
+ */
+Matrix Dense::operator()(const Matrix &x, Workspace &workspace) const
+{
+    Matrix z(_rows, x.getCols(), workspace);
+    apply(x, z);
+    return z;
+}
+
+/**
+ * @fn getWeightsRow
+ * @return the i-th row of the weights as floats
+ */
+const float *Dense::getWeightsRow(int i, float *buffer) const
+{
+    if (isHalf())
+    {
+        convertFromHalf(_cols, _halfWeights.data() + (size_t)i * _cols, buffer, _halfFormat);
+        return buffer;
+    }
+    return _weights->getData() + (size_t)i * _cols;
+}
+
+/**
+ * @fn storeHalf
+ * @brief replaces the weights by a 16-bit copy of them
+ */
+void Dense::storeHalf(HalfFormat format)
+{
+    if (isHalf())
+    {
+        return;
+    }
+    _halfFormat = format;
+    _halfWeights.resize((size_t)_rows * _cols);
+    convertToHalf((int)_halfWeights.size(), _weights->getData(), _halfWeights.data(), format);
+    _weights = nullptr;
+}
+
+/**
+ * @fn getWeightsBytes
+ * @return the size of the weights the layer keeps in memory, in bytes
+ */
+size_t Dense::getWeightsBytes() const
+{
+    return (size_t)_rows * _cols * (isHalf() ? sizeof(uint16_t) : sizeof(float));
+}
+
+/**
+ * @fn getReadBytes
+ * @return the size of the weights a single input reads, in bytes
+ */
+size_t Dense::getReadBytes() const
+{
+    return getWeightsBytes();
+}
+
+/**
+ * @fn gemvRows
+ * @brief computes count outputs of a single input, starting at row first
+ */
+float Dense::gemvRows(int first, int count, const float *x, float *out, GemvEpilogue epilogue) const
+{
+    int n = _cols;
+    if (isHalf())
+    {
+        return gemvHalfFused(count, n, _halfWeights.data() + (size_t)first * n, n, _halfFormat, x,
+                             _bias->getData() + first, out + first, epilogue);
+    }
+    return gemvFused(count, n, _weights->getData() + (size_t)first * n, n, x, _bias->getData() + first,
+                     out + first, epilogue);
+}
+
+/**
+ * @fn apply
+ * @brief calculates the result of the current dense into out
+ */
+void Dense::apply(const Matrix &x, Matrix &out, ThreadPool *pool) const
+{
+    int rows = _rows, cols = x.getCols();
+    if (x.getRows() != _cols || _bias->getRows() != rows || _bias->getCols() != 1)
+    {
+        if (isHalf())
+        {
+            std::cerr << ERROR_DENSE_MULT << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // illegal dimensions, which the Matrix operators report
+        multiplyInto(out, *_weights, x);
+        out += *_bias;
+        return;
+    }
+    if (out.getRows() != rows || out.getCols() != cols)
+    {
+        out = Matrix(rows, cols);
+    }
+
+    if (cols > 1)
+    {
+        // a batch of inputs - the bias of each row is the initial value of the row, then one GEMM over the batch
+        // (which widens 16-bit weights as it packs them)
+        float *data = out.getData();
+        for (int i = 0; i < rows; ++i)
+        {
+            std::fill(data + i * cols, data + (i + 1) * cols, _bias->getData()[i]);
+        }
+        if (isHalf())
+        {
+            gemmHalf(rows, cols, _cols, _halfWeights.data(), _cols, _halfFormat, x.getData(), cols, data, cols);
+        }
+        else
+        {
+            gemm(rows, cols, _cols, _weights->getData(), _cols, x.getData(), cols, data, cols);
+        }
+        _act.applyToColumns(out);
+        return;
+    }
+
+    // a single input - the bias and the activation are applied by the kernel, as each output is stored
+    bool softmax = (_act.getActivationType() == Softmax);
+    GemvEpilogue epilogue = softmax ? GemvExp : GemvRelu;
+    int n = _cols;
+    float sum = 0;
+    int parts = 1;
+    if (pool != nullptr && (long)rows * n >= PARALLEL_GEMV_THRESHOLD)
+    {
+        parts = std::min(std::min(pool->size() + 1, rows / PARALLEL_GEMV_MIN_ROWS), PARALLEL_GEMV_MAX_PARTS);
+    }
+    if (parts > 1)
+    {
+        // the rows are split into parts of whole kernel steps, and each part sums its own outputs
+        int partRows = (rows + parts - 1) / parts;
+        partRows = (partRows + GEMV_ROWS - 1) / GEMV_ROWS * GEMV_ROWS;
+        float sums[PARALLEL_GEMV_MAX_PARTS] = {};
+        pool->parallelFor(parts, [&](int part)
+        {
+            int first = part * partRows, count = std::min(partRows, rows - first);
+            if (count > 0)
+            {
+                sums[part] = gemvRows(first, count, x.getData(), out.getData(), epilogue);
+            }
+        });
+        for (int part = 0; part < parts; ++part)
+        {
+            sum += sums[part];
+        }
+    }
+    else
+    {
+        sum = gemvRows(0, rows, x.getData(), out.getData(), epilogue);
+    }
+    if (softmax)
+    {
+        float *data = out.getData();
+        for (int i = 0; i < rows; ++i)
+        {
+            data[i] = data[i] * (1 / sum);
+        }
+    }
 }
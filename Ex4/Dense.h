@@ -9,6 +9,13 @@
 // ------------------------------ includes ------------------------------
 #include "Matrix.h"
 #include "Activation.h"
+#include "ThreadPool.h"
+#include "Gemm.h"
+#include <vector>
+// -------------------------- const definitions -------------------------
+#define PARALLEL_GEMV_THRESHOLD 65536 // weights of a layer, below which a single input is not split across threads
+#define PARALLEL_GEMV_MIN_ROWS 16 // rows of a part of a split layer
+#define PARALLEL_GEMV_MAX_PARTS 64
 // ------------------------------ method definitions -----------------------------
 
 /**
@@ -19,32 +26,102 @@ class Dense
 {
 private:
     const Activation _act; // activation function
-    const Matrix _weights; // weights matrix
-    const Matrix _bias; // bias matrix
+    int _rows, _cols; // the size of the weights matrix
+    const Matrix *_weights; // weights matrix (not copied - must outlive the Dense), null once storeHalf is called
+    const Matrix *_bias; // bias matrix (not copied - must outlive the Dense)
+    HalfFormat _halfFormat; // the format of _halfWeights
+    std::vector<uint16_t> _halfWeights; // if not empty, a 16-bit copy of the weights, which replaces _weights
+
+    /**
+     * @fn gemvRows
+     * @brief computes count outputs of a single input, starting at row first
+     * @return the sum of the outputs if epilogue is GemvExp, 0 otherwise
+     */
+    float gemvRows(int first, int count, const float *x, float *out, GemvEpilogue epilogue) const;
 
 public:
     /**
      * @fn Constructor
+     * @brief a layer which reads the given weights and bias in place - they are not copied, and must outlive
+     *        the Dense (and every copy of it), or in the case of the weights, until storeHalf is called
      */
-    Dense(const Matrix& w, const Matrix& bias, ActivationType actType) : _act(actType), _weights(w), _bias(bias) {}
+    Dense(const Matrix *w, const Matrix *bias, ActivationType actType)
+        : _act(actType), _rows(w->getRows()), _cols(w->getCols()), _weights(w), _bias(bias), _halfFormat(Fp16) {}
 
     /**
      * @fn Getters
+     * @brief the number of outputs (the rows of the weights)
      */
-    const Matrix& getWeights() const { return _weights; }
+    int getRows() const { return _rows; }
+    /**
+     * @fn Getters
+     * @brief the size of an input (the columns of the weights)
+     */
+    int getCols() const { return _cols; }
     /**
     * @fn Getters
     */
-    const Matrix& getBias() const { return _bias; }
+    const Matrix& getBias() const { return *_bias; }
     /**
     * @fn Getters
     */
     Activation getActivation() const { return _act; }
 
+    /**
+     * @fn getWeightsRow
+     * @brief the i-th row of the weights as floats
+     * @param buffer - getCols() floats, into which a 16-bit row is converted
+     * @return the row in the fp32 weights, or buffer once storeHalf is called
+     */
+    const float *getWeightsRow(int i, float *buffer) const;
+
+    /**
+     * @fn storeHalf
+     * @brief replaces the weights by a copy of them in a 16-bit format (half of the memory and of the memory
+     *        traffic, and the sums are still computed in fp32): a single input widens the weights as it reads
+     *        them, and a batch as it packs them. the layer stops referring to the fp32 weights, so the caller may
+     *        release them.
+     */
+    void storeHalf(HalfFormat format);
+
+    /**
+     * @fn isHalf
+     * @return whether the layer keeps 16-bit weights
+     */
+    bool isHalf() const { return !_halfWeights.empty(); }
+
+    /**
+     * @fn getWeightsBytes
+     * @return the size of the weights the layer keeps in memory, in bytes
+     */
+    size_t getWeightsBytes() const;
+
+    /**
+     * @fn getReadBytes
+     * @return the size of the weights a single input reads, in bytes
+     */
+    size_t getReadBytes() const;
+
     /**
      * @fn This function calculates the result of the current dense
      */
-    Matrix operator()(const Matrix &x);
+    Matrix operator()(const Matrix &x) const;
+
+    /**
+     * @fn operator ()
+     * @brief as operator()(x), with the result in a matrix of a workspace (see Matrix(rows, cols, workspace))
+     */
+    Matrix operator()(const Matrix &x, Workspace &workspace) const;
+
+    /**
+     * @fn apply
+     * @brief calculates the result of the current dense into out, which is reallocated only if its size
+     *        is different from the size of the result (out must not be x). each column of x is a separate
+     *        input, and the matching column of out is its result.
+     * @param pool - if not null, a single input to a large layer (PARALLEL_GEMV_THRESHOLD weights or more) is
+     *        computed by the calling thread and the pool's workers together, each on a part of the rows
+     */
+    void apply(const Matrix &x, Matrix &out, ThreadPool *pool = nullptr) const;
 };
 
 #endif //DENSE_H
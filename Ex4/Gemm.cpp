@@ -0,0 +1,883 @@
+/**
+ * @file Gemm.cpp
+ * @author Ron Shuvy
+ * @brief This file implements a cache-blocked, register-tiled matrix multiplication, and a SIMD
+ *        matrix-vector multiplication
+ *
+ * B is packed into panels of GEMM_KC x GEMM_NC and A into blocks of GEMM_MC x GEMM_KC, both split into
+ * slivers of GEMM_NR columns / GEMM_MR rows which are contiguous in k order. the micro-kernel then keeps a
+ * GEMM_MR x GEMM_NR tile of C in registers while it streams one sliver of A and one sliver of B. the packing
+ * buffers are kept per thread, and grow to the largest block size used.
+ *
+ * A matrix-vector product is memory bound (every weight is used once), so gemv streams GEMV_ROWS rows of A at a
+ * time against x with independent accumulators. the AVX2/FMA version is selected once, at the first call, by
+ * checking the CPU. the fused version adds a bias and applies an activation to each output before it is stored.
+ * the int8 version multiplies 32 pairs of bytes per instruction, into 16-bit pair sums and then 32-bit sums.
+ * the 16-bit versions read half of the bytes of the float version, and widen 8 weights at a time to floats.
+ * the 16-bit gemm widens A to floats as it packs it, so it runs the same micro-kernels as the float version.
+ */
+// ------------------------------ includes ------------------------------
+#include "Gemm.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define KERNELS_X86
+#endif
+// -------------------------- const definitions -------------------------
+#define GEMV_LANES 8 // independent partial sums of a row
+// ------------------------------ function definitions -----------------------------
+
+/**
+ * @brief packs an mc x kc block of A into slivers of GEMM_MR rows (zero-padded)
+ */
+static void packA(int mc, int kc, const float *a, int lda, float *packed)
+{
+    for (int i = 0; i < mc; i += GEMM_MR)
+    {
+        for (int p = 0; p < kc; ++p)
+        {
+            for (int r = 0; r < GEMM_MR; ++r)
+            {
+                *packed++ = (i + r < mc) ? a[(i + r) * lda + p] : 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief packs a kc x nc panel of B into slivers of GEMM_NR columns (zero-padded)
+ */
+static void packB(int kc, int nc, const float *b, int ldb, float *packed)
+{
+    for (int j = 0; j < nc; j += GEMM_NR)
+    {
+        for (int p = 0; p < kc; ++p)
+        {
+            for (int r = 0; r < GEMM_NR; ++r)
+            {
+                *packed++ = (j + r < nc) ? b[p * ldb + j + r] : 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief adds the product of a packed sliver of A and a packed sliver of B to the mr x nr tile of C
+ */
+static void microKernel(int kc, const float *__restrict a, const float *__restrict b, float *c, int ldc,
+                        int mr, int nr)
+{
+    float acc[GEMM_MR][GEMM_NR] = {};
+    for (int p = 0; p < kc; ++p)
+    {
+        for (int i = 0; i < GEMM_MR; ++i)
+        {
+            for (int j = 0; j < GEMM_NR; ++j)
+            {
+                acc[i][j] += a[p * GEMM_MR + i] * b[p * GEMM_NR + j];
+            }
+        }
+    }
+    for (int i = 0; i < mr; ++i)
+    {
+        for (int j = 0; j < nr; ++j)
+        {
+            c[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+#ifdef KERNELS_X86
+/**
+ * @brief AVX2/FMA micro-kernel - the GEMM_MR x GEMM_NR tile is kept in 12 AVX registers
+ */
+__attribute__((target("avx2,fma"))) static void microKernelAvx2(int kc, const float *a, const float *b, float *c,
+                                                                int ldc, int mr, int nr)
+{
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(), c10 = _mm256_setzero_ps();
+    __m256 c11 = _mm256_setzero_ps(), c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps(), c40 = _mm256_setzero_ps();
+    __m256 c41 = _mm256_setzero_ps(), c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+    for (int p = 0; p < kc; ++p, a += GEMM_MR, b += GEMM_NR)
+    {
+        __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+        __m256 ai = _mm256_broadcast_ss(a);
+        c00 = _mm256_fmadd_ps(ai, b0, c00), c01 = _mm256_fmadd_ps(ai, b1, c01);
+        ai = _mm256_broadcast_ss(a + 1);
+        c10 = _mm256_fmadd_ps(ai, b0, c10), c11 = _mm256_fmadd_ps(ai, b1, c11);
+        ai = _mm256_broadcast_ss(a + 2);
+        c20 = _mm256_fmadd_ps(ai, b0, c20), c21 = _mm256_fmadd_ps(ai, b1, c21);
+        ai = _mm256_broadcast_ss(a + 3);
+        c30 = _mm256_fmadd_ps(ai, b0, c30), c31 = _mm256_fmadd_ps(ai, b1, c31);
+        ai = _mm256_broadcast_ss(a + 4);
+        c40 = _mm256_fmadd_ps(ai, b0, c40), c41 = _mm256_fmadd_ps(ai, b1, c41);
+        ai = _mm256_broadcast_ss(a + 5);
+        c50 = _mm256_fmadd_ps(ai, b0, c50), c51 = _mm256_fmadd_ps(ai, b1, c51);
+    }
+    float acc[GEMM_MR][GEMM_NR];
+    _mm256_storeu_ps(acc[0], c00), _mm256_storeu_ps(acc[0] + 8, c01);
+    _mm256_storeu_ps(acc[1], c10), _mm256_storeu_ps(acc[1] + 8, c11);
+    _mm256_storeu_ps(acc[2], c20), _mm256_storeu_ps(acc[2] + 8, c21);
+    _mm256_storeu_ps(acc[3], c30), _mm256_storeu_ps(acc[3] + 8, c31);
+    _mm256_storeu_ps(acc[4], c40), _mm256_storeu_ps(acc[4] + 8, c41);
+    _mm256_storeu_ps(acc[5], c50), _mm256_storeu_ps(acc[5] + 8, c51);
+    for (int i = 0; i < mr; ++i)
+    {
+        for (int j = 0; j < nr; ++j)
+        {
+            c[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+#endif
+
+/**
+ * @brief checks whether the running CPU supports AVX2 and FMA
+ */
+static bool hasAvx2Fma()
+{
+#ifdef KERNELS_X86
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief a micro-kernel implementation
+ */
+typedef void (*MicroKernel)(int, const float *, const float *, float *, int, int, int);
+
+/**
+ * @brief a packing of a block of A, whose elements are of type T, into slivers of floats (as packA)
+ */
+template <typename T>
+using PackAFunc = void (*)(int, int, const T *, int, float *);
+
+/**
+ * @brief chooses the micro-kernel implementation for the running CPU
+ */
+static MicroKernel selectMicroKernel()
+{
+#ifdef KERNELS_X86
+    if (hasAvx2Fma())
+    {
+        return microKernelAvx2;
+    }
+#endif
+    return microKernel;
+}
+
+/**
+ * @brief computes C += A * B (row-major), packing the blocks of A with packBlockA
+ */
+template <typename T>
+static void gemmBlocked(int m, int n, int k, const T *a, int lda, PackAFunc<T> packBlockA, const float *b,
+                        int ldb, float *c, int ldc)
+{
+    static const MicroKernel kernel = selectMicroKernel();
+    int kcMax = std::min(k, GEMM_KC);
+    int mcMax = (std::min(m, GEMM_MC) + GEMM_MR - 1) / GEMM_MR * GEMM_MR;
+    int ncMax = (std::min(n, GEMM_NC) + GEMM_NR - 1) / GEMM_NR * GEMM_NR;
+    static thread_local std::vector<float> packedA, packedB;
+    packedA.resize(std::max(packedA.size(), (size_t)mcMax * kcMax));
+    packedB.resize(std::max(packedB.size(), (size_t)kcMax * ncMax));
+
+    for (int jc = 0; jc < n; jc += GEMM_NC)
+    {
+        int nc = std::min(GEMM_NC, n - jc);
+        for (int pc = 0; pc < k; pc += GEMM_KC)
+        {
+            int kc = std::min(GEMM_KC, k - pc);
+            packB(kc, nc, b + (size_t)pc * ldb + jc, ldb, packedB.data());
+            for (int ic = 0; ic < m; ic += GEMM_MC)
+            {
+                int mc = std::min(GEMM_MC, m - ic);
+                packBlockA(mc, kc, a + (size_t)ic * lda + pc, lda, packedA.data());
+                for (int jr = 0; jr < nc; jr += GEMM_NR)
+                {
+                    for (int ir = 0; ir < mc; ir += GEMM_MR)
+                    {
+                        kernel(kc, packedA.data() + (size_t)ir * kc, packedB.data() + (size_t)jr * kc,
+                                    c + (size_t)(ic + ir) * ldc + jc + jr, ldc,
+                                    std::min(GEMM_MR, mc - ir), std::min(GEMM_NR, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @fn gemm
+ * @brief computes C += A * B (row-major)
+ */
+void gemm(int m, int n, int k, const float *a, int lda, const float *b, int ldb, float *c, int ldc)
+{
+    gemmBlocked<float>(m, n, k, a, lda, packA, b, ldb, c, ldc);
+}
+
+/**
+ * @brief applies an epilogue to a single output
+ */
+static inline float finish(float v, GemvEpilogue epilogue)
+{
+    if (epilogue == GemvRelu)
+    {
+        return (v >= 0) ? v : 0;
+    }
+    if (epilogue == GemvExp)
+    {
+        return (float)std::exp(v);
+    }
+    return v;
+}
+
+/**
+ * @brief portable gemv - GEMV_LANES partial sums per row, which the compiler can vectorize
+ */
+static void gemvPortable(int m, int n, const float *a, int lda, const float *x, const float *bias, float *y,
+                         GemvEpilogue epilogue)
+{
+    int nVec = n / GEMV_LANES * GEMV_LANES;
+    for (int i = 0; i < m; ++i)
+    {
+        const float *row = a + (size_t)i * lda;
+        float acc[GEMV_LANES] = {};
+        for (int j = 0; j < nVec; j += GEMV_LANES)
+        {
+            for (int l = 0; l < GEMV_LANES; ++l)
+            {
+                acc[l] += row[j + l] * x[j + l];
+            }
+        }
+        float sum = 0;
+        for (int l = 0; l < GEMV_LANES; ++l)
+        {
+            sum += acc[l];
+        }
+        for (int j = nVec; j < n; ++j)
+        {
+            sum += row[j] * x[j];
+        }
+        y[i] = finish(sum + bias[i], epilogue);
+    }
+}
+
+#ifdef KERNELS_X86
+/**
+ * @brief sums the 8 lanes of an AVX register
+ */
+__attribute__((target("avx2,fma"))) static inline float horizontalSum(__m256 v)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+/**
+ * @brief AVX2/FMA gemv - GEMV_ROWS rows at a time, so each load of x is used GEMV_ROWS times
+ */
+__attribute__((target("avx2,fma"))) static void gemvAvx2(int m, int n, const float *a, int lda, const float *x,
+                                                         const float *bias, float *y, GemvEpilogue epilogue)
+{
+    int nVec = n / 8 * 8;
+    int i = 0;
+    for (; i + GEMV_ROWS <= m; i += GEMV_ROWS)
+    {
+        const float *r0 = a + (size_t)i * lda;
+        const float *r1 = r0 + lda;
+        const float *r2 = r1 + lda;
+        const float *r3 = r2 + lda;
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+        for (int j = 0; j < nVec; j += 8)
+        {
+            __m256 xv = _mm256_loadu_ps(x + j);
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + j), xv, acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(r1 + j), xv, acc1);
+            acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(r2 + j), xv, acc2);
+            acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(r3 + j), xv, acc3);
+        }
+        float s0 = horizontalSum(acc0), s1 = horizontalSum(acc1);
+        float s2 = horizontalSum(acc2), s3 = horizontalSum(acc3);
+        for (int j = nVec; j < n; ++j)
+        {
+            s0 += r0[j] * x[j], s1 += r1[j] * x[j], s2 += r2[j] * x[j], s3 += r3[j] * x[j];
+        }
+        y[i] = finish(s0 + bias[i], epilogue);
+        y[i + 1] = finish(s1 + bias[i + 1], epilogue);
+        y[i + 2] = finish(s2 + bias[i + 2], epilogue);
+        y[i + 3] = finish(s3 + bias[i + 3], epilogue);
+    }
+    for (; i < m; ++i)
+    {
+        const float *row = a + (size_t)i * lda;
+        __m256 acc = _mm256_setzero_ps();
+        for (int j = 0; j < nVec; j += 8)
+        {
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(row + j), _mm256_loadu_ps(x + j), acc);
+        }
+        float sum = horizontalSum(acc);
+        for (int j = nVec; j < n; ++j)
+        {
+            sum += row[j] * x[j];
+        }
+        y[i] = finish(sum + bias[i], epilogue);
+    }
+}
+#endif
+
+/**
+ * @brief sums the outputs of an exp epilogue (the softmax denominator)
+ */
+static float epilogueSum(int m, const float *y, GemvEpilogue epilogue)
+{
+    float sum = 0;
+    if (epilogue == GemvExp)
+    {
+        for (int i = 0; i < m; ++i)
+        {
+            sum += y[i];
+        }
+    }
+    return sum;
+}
+
+/**
+ * @brief a gemv implementation
+ */
+typedef void (*GemvKernel)(int, int, const float *, int, const float *, const float *, float *, GemvEpilogue);
+
+/**
+ * @brief chooses the gemv implementation for the running CPU
+ */
+static GemvKernel selectGemv()
+{
+#ifdef KERNELS_X86
+    if (hasAvx2Fma())
+    {
+        return gemvAvx2;
+    }
+#endif
+    return gemvPortable;
+}
+
+/**
+ * @fn gemvFused
+ * @brief computes y = epilogue(A * x + bias), writing each output once
+ */
+float gemvFused(int m, int n, const float *a, int lda, const float *x, const float *bias, float *y,
+                GemvEpilogue epilogue)
+{
+    static const GemvKernel kernel = selectGemv();
+    kernel(m, n, a, lda, x, bias, y, epilogue);
+    return epilogueSum(m, y, epilogue);
+}
+
+/**
+ * @brief portable int8 gemv
+ */
+static void gemvInt8Portable(int m, int n, const int8_t *a, int lda, const float *rowScales, const int8_t *x,
+                             float xScale, const float *bias, float *y, GemvEpilogue epilogue)
+{
+    for (int i = 0; i < m; ++i)
+    {
+        const int8_t *row = a + (size_t)i * lda;
+        int32_t dot = 0;
+        for (int j = 0; j < n; ++j)
+        {
+            dot += (int32_t)row[j] * x[j];
+        }
+        y[i] = finish(rowScales[i] * xScale * (float)dot + bias[i], epilogue);
+    }
+}
+
+#ifdef KERNELS_X86
+/**
+ * @brief sums the 8 lanes of a 32-bit integer AVX register
+ */
+__attribute__((target("avx2"))) static inline int32_t horizontalSumInt(__m256i v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+/**
+ * @brief the 32-bit sums of 32 products of signed bytes: maddubs needs an unsigned operand, so |x| is multiplied by
+ *        a with the sign of x (the 16-bit pair sums are at most 2 * 127 * 127, so they do not saturate)
+ */
+__attribute__((target("avx2"))) static inline __m256i dotInt8(__m256i absX, __m256i x, __m256i a)
+{
+    __m256i pairs = _mm256_maddubs_epi16(absX, _mm256_sign_epi8(a, x));
+    return _mm256_madd_epi16(pairs, _mm256_set1_epi16(1));
+}
+
+/**
+ * @brief AVX2 int8 gemv - GEMV_ROWS rows at a time, 32 bytes per step
+ */
+__attribute__((target("avx2"))) static void gemvInt8Avx2(int m, int n, const int8_t *a, int lda,
+                                                         const float *rowScales, const int8_t *x, float xScale,
+                                                         const float *bias, float *y, GemvEpilogue epilogue)
+{
+    int nVec = n / 32 * 32;
+    int i = 0;
+    for (; i + GEMV_ROWS <= m; i += GEMV_ROWS)
+    {
+        const int8_t *r0 = a + (size_t)i * lda;
+        const int8_t *r1 = r0 + lda;
+        const int8_t *r2 = r1 + lda;
+        const int8_t *r3 = r2 + lda;
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+        __m256i acc2 = _mm256_setzero_si256(), acc3 = _mm256_setzero_si256();
+        for (int j = 0; j < nVec; j += 32)
+        {
+            __m256i xv = _mm256_loadu_si256((const __m256i *)(x + j));
+            __m256i absX = _mm256_sign_epi8(xv, xv);
+            acc0 = _mm256_add_epi32(acc0, dotInt8(absX, xv, _mm256_loadu_si256((const __m256i *)(r0 + j))));
+            acc1 = _mm256_add_epi32(acc1, dotInt8(absX, xv, _mm256_loadu_si256((const __m256i *)(r1 + j))));
+            acc2 = _mm256_add_epi32(acc2, dotInt8(absX, xv, _mm256_loadu_si256((const __m256i *)(r2 + j))));
+            acc3 = _mm256_add_epi32(acc3, dotInt8(absX, xv, _mm256_loadu_si256((const __m256i *)(r3 + j))));
+        }
+        int32_t d0 = horizontalSumInt(acc0), d1 = horizontalSumInt(acc1);
+        int32_t d2 = horizontalSumInt(acc2), d3 = horizontalSumInt(acc3);
+        for (int j = nVec; j < n; ++j)
+        {
+            d0 += (int32_t)r0[j] * x[j], d1 += (int32_t)r1[j] * x[j];
+            d2 += (int32_t)r2[j] * x[j], d3 += (int32_t)r3[j] * x[j];
+        }
+        y[i] = finish(rowScales[i] * xScale * (float)d0 + bias[i], epilogue);
+        y[i + 1] = finish(rowScales[i + 1] * xScale * (float)d1 + bias[i + 1], epilogue);
+        y[i + 2] = finish(rowScales[i + 2] * xScale * (float)d2 + bias[i + 2], epilogue);
+        y[i + 3] = finish(rowScales[i + 3] * xScale * (float)d3 + bias[i + 3], epilogue);
+    }
+    gemvInt8Portable(m - i, n, a + (size_t)i * lda, lda, rowScales + i, x, xScale, bias + i, y + i, epilogue);
+}
+#endif
+
+/**
+ * @brief rounds to the nearest integer, half to even - the rounding of _mm256_cvtps_epi32, so the tail of the AVX2
+ *        quantization and the portable quantization give the same values
+ */
+static inline int8_t roundToInt8(float v)
+{
+    return (int8_t)(int)std::nearbyint(v);
+}
+
+/**
+ * @brief the scale which maps the largest absolute value to 127
+ */
+static inline float int8Scale(float maxAbs)
+{
+    return (maxAbs > 0) ? maxAbs / 127 : 1;
+}
+
+/**
+ * @brief portable quantization
+ */
+static float quantizeInt8Portable(int n, const float *x, int8_t *q)
+{
+    float maxAbs = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        float v = (x[i] < 0) ? -x[i] : x[i];
+        maxAbs = (v > maxAbs) ? v : maxAbs;
+    }
+    float scale = int8Scale(maxAbs), inverse = 1 / scale;
+    for (int i = 0; i < n; ++i)
+    {
+        q[i] = roundToInt8(x[i] * inverse);
+    }
+    return scale;
+}
+
+#ifdef KERNELS_X86
+/**
+ * @brief AVX2 quantization - 32 values per step, packed 32 -> 16 -> 8 bits (the packs work within 128-bit lanes,
+ *        so the 32-bit groups are permuted back into order)
+ */
+__attribute__((target("avx2"))) static float quantizeInt8Avx2(int n, const float *x, int8_t *q)
+{
+    int nVec = n / 8 * 8;
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 maxVec = _mm256_setzero_ps();
+    for (int i = 0; i < nVec; i += 8)
+    {
+        maxVec = _mm256_max_ps(maxVec, _mm256_and_ps(_mm256_loadu_ps(x + i), absMask));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, maxVec);
+    float maxAbs = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        maxAbs = (lanes[i] > maxAbs) ? lanes[i] : maxAbs;
+    }
+    for (int i = nVec; i < n; ++i)
+    {
+        float v = (x[i] < 0) ? -x[i] : x[i];
+        maxAbs = (v > maxAbs) ? v : maxAbs;
+    }
+
+    float scale = int8Scale(maxAbs), inverse = 1 / scale;
+    const __m256 inv = _mm256_set1_ps(inverse);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i a = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(x + i), inv));
+        __m256i b = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(x + i + 8), inv));
+        __m256i c = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(x + i + 16), inv));
+        __m256i d = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(x + i + 24), inv));
+        __m256i packed = _mm256_packs_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        _mm256_storeu_si256((__m256i *)(q + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    for (; i < n; ++i)
+    {
+        q[i] = roundToInt8(x[i] * inverse);
+    }
+    return scale;
+}
+#endif
+
+/**
+ * @fn quantizeInt8
+ * @brief quantizes n floats symmetrically with a single scale
+ */
+float quantizeInt8(int n, const float *x, int8_t *q)
+{
+#ifdef KERNELS_X86
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2)
+    {
+        return quantizeInt8Avx2(n, x, q);
+    }
+#endif
+    return quantizeInt8Portable(n, x, q);
+}
+
+/**
+ * @brief an int8 gemv implementation
+ */
+typedef void (*GemvInt8Kernel)(int, int, const int8_t *, int, const float *, const int8_t *, float, const float *,
+                               float *, GemvEpilogue);
+
+/**
+ * @brief chooses the int8 gemv implementation for the running CPU
+ */
+static GemvInt8Kernel selectGemvInt8()
+{
+#ifdef KERNELS_X86
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return gemvInt8Avx2;
+    }
+#endif
+    return gemvInt8Portable;
+}
+
+/**
+ * @fn gemvInt8Fused
+ * @brief computes y = epilogue(rowScales * xScale * (A * x) + bias) for quantized A and x
+ */
+float gemvInt8Fused(int m, int n, const int8_t *a, int lda, const float *rowScales, const int8_t *x, float xScale,
+                    const float *bias, float *y, GemvEpilogue epilogue)
+{
+    static const GemvInt8Kernel kernel = selectGemvInt8();
+    kernel(m, n, a, lda, rowScales, x, xScale, bias, y, epilogue);
+    return epilogueSum(m, y, epilogue);
+}
+
+/**
+ * @brief converts a float to IEEE half precision, rounding to the nearest even value (overflows become infinity)
+ */
+static uint16_t floatToFp16(float value)
+{
+    uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+    uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+    uint16_t h;
+    if (f >= (127u + 16) << 23)
+    {
+        // too large for a half (or infinity / NaN)
+        h = (f > 0x7f800000u) ? 0x7e00 : 0x7c00;
+    }
+    else if (f < (127u - 14) << 23)
+    {
+        // a subnormal half - adding 0.5 shifts the mantissa into place, and the float addition rounds it
+        const uint32_t magicBits = (127u - 1) << 23;
+        float magic, v;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        std::memcpy(&v, &f, sizeof(v));
+        v += magic;
+        std::memcpy(&f, &v, sizeof(f));
+        h = (uint16_t)(f - magicBits);
+    }
+    else
+    {
+        uint32_t mantissaOdd = (f >> 13) & 1;
+        f -= (127u - 15) << 23;
+        f += 0xfff + mantissaOdd;
+        h = (uint16_t)(f >> 13);
+    }
+    return (uint16_t)(h | (sign >> 16));
+}
+
+/**
+ * @brief converts an IEEE half to a float
+ */
+static float fp16ToFloat(uint16_t h)
+{
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16, exponent = (h >> 10) & 0x1f, mantissa = h & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f)
+    {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    }
+    else if (exponent != 0)
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    else if (mantissa == 0)
+    {
+        bits = sign;
+    }
+    else
+    {
+        // a subnormal half is a normal float
+        exponent = 127 - 14;
+        while (!(mantissa & 0x400))
+        {
+            mantissa <<= 1, --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief converts a float to bfloat16, rounding to the nearest even value
+ */
+static uint16_t floatToBf16(float value)
+{
+    uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+    if ((f & 0x7fffffffu) > 0x7f800000u)
+    {
+        // NaN - keep it a NaN
+        return (uint16_t)((f >> 16) | 0x40);
+    }
+    return (uint16_t)((f + 0x7fff + ((f >> 16) & 1)) >> 16);
+}
+
+/**
+ * @brief converts a bfloat16 to a float
+ */
+static inline float bf16ToFloat(uint16_t h)
+{
+    uint32_t bits = (uint32_t)h << 16;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @fn convertToHalf
+ * @brief converts n floats to the given 16-bit format
+ */
+void convertToHalf(int n, const float *x, uint16_t *h, HalfFormat format)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        h[i] = (format == Fp16) ? floatToFp16(x[i]) : floatToBf16(x[i]);
+    }
+}
+
+/**
+ * @fn convertFromHalf
+ * @brief converts n 16-bit values of the given format to floats
+ */
+void convertFromHalf(int n, const uint16_t *h, float *x, HalfFormat format)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        x[i] = (format == Fp16) ? fp16ToFloat(h[i]) : bf16ToFloat(h[i]);
+    }
+}
+
+/**
+ * @brief packs an mc x kc block of a 16-bit A into slivers of GEMM_MR rows of floats (zero-padded)
+ */
+template <HalfFormat format>
+static void packHalfA(int mc, int kc, const uint16_t *a, int lda, float *packed)
+{
+    for (int i = 0; i < mc; i += GEMM_MR)
+    {
+        for (int p = 0; p < kc; ++p)
+        {
+            for (int r = 0; r < GEMM_MR; ++r)
+            {
+                uint16_t h = a[(i + r) * lda + p];
+                *packed++ = (i + r >= mc) ? 0 : (format == Fp16) ? fp16ToFloat(h) : bf16ToFloat(h);
+            }
+        }
+    }
+}
+
+/**
+ * @fn gemmHalf
+ * @brief computes C += A * B (row-major) for a 16-bit A
+ */
+void gemmHalf(int m, int n, int k, const uint16_t *a, int lda, HalfFormat format, const float *b, int ldb,
+              float *c, int ldc)
+{
+    gemmBlocked<uint16_t>(m, n, k, a, lda, (format == Fp16) ? packHalfA<Fp16> : packHalfA<Bf16>, b, ldb, c, ldc);
+}
+
+/**
+ * @brief portable 16-bit gemv
+ */
+template <HalfFormat format>
+static void gemvHalfPortable(int m, int n, const uint16_t *a, int lda, const float *x, const float *bias,
+                             float *y, GemvEpilogue epilogue)
+{
+    for (int i = 0; i < m; ++i)
+    {
+        const uint16_t *row = a + (size_t)i * lda;
+        float sum = 0;
+        for (int j = 0; j < n; ++j)
+        {
+            sum += ((format == Fp16) ? fp16ToFloat(row[j]) : bf16ToFloat(row[j])) * x[j];
+        }
+        y[i] = finish(sum + bias[i], epilogue);
+    }
+}
+
+#ifdef KERNELS_X86
+/**
+ * @brief widens 8 16-bit values to floats
+ */
+template <HalfFormat format>
+__attribute__((target("avx2,fma,f16c"))) static inline __m256 loadHalf(const uint16_t *h)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)h);
+    if (format == Fp16)
+    {
+        return _mm256_cvtph_ps(v);
+    }
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(v), 16));
+}
+
+/**
+ * @brief converts a single 16-bit value to a float inside the AVX kernel (calling the portable conversion from
+ *        AVX code would mix in SSE instructions, which stall while the upper halves of the registers are in use)
+ */
+template <HalfFormat format>
+__attribute__((target("avx2,fma,f16c"))) static inline float halfToFloat(uint16_t h)
+{
+    return (format == Fp16) ? _cvtsh_ss(h) : bf16ToFloat(h);
+}
+
+/**
+ * @brief AVX2/FMA 16-bit gemv - GEMV_ROWS rows at a time, as the float version
+ */
+template <HalfFormat format>
+__attribute__((target("avx2,fma,f16c"))) static void gemvHalfAvx2(int m, int n, const uint16_t *a, int lda,
+                                                                  const float *x, const float *bias, float *y,
+                                                                  GemvEpilogue epilogue)
+{
+    int nVec = n / 8 * 8;
+    int i = 0;
+    for (; i + GEMV_ROWS <= m; i += GEMV_ROWS)
+    {
+        const uint16_t *r0 = a + (size_t)i * lda;
+        const uint16_t *r1 = r0 + lda;
+        const uint16_t *r2 = r1 + lda;
+        const uint16_t *r3 = r2 + lda;
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+        for (int j = 0; j < nVec; j += 8)
+        {
+            __m256 xv = _mm256_loadu_ps(x + j);
+            acc0 = _mm256_fmadd_ps(loadHalf<format>(r0 + j), xv, acc0);
+            acc1 = _mm256_fmadd_ps(loadHalf<format>(r1 + j), xv, acc1);
+            acc2 = _mm256_fmadd_ps(loadHalf<format>(r2 + j), xv, acc2);
+            acc3 = _mm256_fmadd_ps(loadHalf<format>(r3 + j), xv, acc3);
+        }
+        float s0 = horizontalSum(acc0), s1 = horizontalSum(acc1);
+        float s2 = horizontalSum(acc2), s3 = horizontalSum(acc3);
+        for (int j = nVec; j < n; ++j)
+        {
+            float xj = x[j];
+            s0 += halfToFloat<format>(r0[j]) * xj, s1 += halfToFloat<format>(r1[j]) * xj;
+            s2 += halfToFloat<format>(r2[j]) * xj, s3 += halfToFloat<format>(r3[j]) * xj;
+        }
+        y[i] = finish(s0 + bias[i], epilogue);
+        y[i + 1] = finish(s1 + bias[i + 1], epilogue);
+        y[i + 2] = finish(s2 + bias[i + 2], epilogue);
+        y[i + 3] = finish(s3 + bias[i + 3], epilogue);
+    }
+    for (; i < m; ++i)
+    {
+        const uint16_t *row = a + (size_t)i * lda;
+        float sum = 0;
+        for (int j = 0; j < n; ++j)
+        {
+            sum += halfToFloat<format>(row[j]) * x[j];
+        }
+        y[i] = finish(sum + bias[i], epilogue);
+    }
+}
+#endif
+
+/**
+ * @brief a 16-bit gemv implementation
+ */
+typedef void (*GemvHalfKernel)(int, int, const uint16_t *, int, const float *, const float *, float *,
+                               GemvEpilogue);
+
+/**
+ * @brief chooses the 16-bit gemv implementation for the running CPU
+ */
+template <HalfFormat format>
+static GemvHalfKernel selectGemvHalf()
+{
+#ifdef KERNELS_X86
+    if (hasAvx2Fma() && (format == Bf16 || __builtin_cpu_supports("f16c")))
+    {
+        return gemvHalfAvx2<format>;
+    }
+#endif
+    return gemvHalfPortable<format>;
+}
+
+/**
+ * @fn gemvHalfFused
+ * @brief computes y = epilogue(A * x + bias) for a 16-bit A
+ */
+float gemvHalfFused(int m, int n, const uint16_t *a, int lda, HalfFormat format, const float *x, const float *bias,
+                    float *y, GemvEpilogue epilogue)
+{
+    static const GemvHalfKernel fp16Kernel = selectGemvHalf<Fp16>();
+    static const GemvHalfKernel bf16Kernel = selectGemvHalf<Bf16>();
+    (format == Fp16 ? fp16Kernel : bf16Kernel)(m, n, a, lda, x, bias, y, epilogue);
+    return epilogueSum(m, y, epilogue);
+}
+
+/**
+ * @fn gemv
+ * @brief computes y += A * x (row-major)
+ */
+void gemv(int m, int n, const float *a, int lda, const float *x, float *y)
+{
+    // y is the bias - each output reads its own bias before it is written
+    gemvFused(m, n, a, lda, x, y, y, GemvIdentity);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file Gemm.h
+ * @author Ron Shuvy
+ * @brief This header file defines the matrix multiplication kernels of the Matrix class
+ */
+
+#ifndef GEMM_H
+#define GEMM_H
+// ------------------------------ includes ------------------------------
+#include <cstdint>
+// -------------------------- const definitions -------------------------
+#define GEMM_MR 6 // rows of the register tile
+#define GEMM_NR 16 // columns of the register tile
+#define GEMM_MC 128 // rows of a packed block of A (kept in L2)
+#define GEMM_KC 256 // depth of the packed panels
+#define GEMM_NC 2048 // columns of a packed panel of B (kept in L3)
+#define GEMV_ROWS 4 // rows of A which gemv multiplies together
+// ------------------------------ type definitions -----------------------------
+/**
+ * @enum GemvEpilogue
+ * @brief a function which gemvFused applies to each output
+ */
+enum GemvEpilogue
+{
+    GemvIdentity,
+    GemvRelu,
+    GemvExp
+};
+
+/**
+ * @enum HalfFormat
+ * @brief a 16-bit floating point format: IEEE half precision (5 exponent bits, 10 mantissa bits) or bfloat16
+ *        (the upper half of a float - the range of a float, with 7 mantissa bits)
+ */
+enum HalfFormat
+{
+    Fp16,
+    Bf16
+};
+// ------------------------------ function declarations -----------------------------
+
+/**
+ * @fn gemm
+ * @brief computes C += A * B, where A is m x k, B is k x n and C is m x n. all matrices are row-major,
+ *        with a row stride (leading dimension) of lda, ldb and ldc floats.
+ */
+void gemm(int m, int n, int k, const float *a, int lda, const float *b, int ldb, float *c, int ldc);
+
+/**
+ * @fn gemmHalf
+ * @brief the 16-bit version of gemm: computes C += A * B, where A is stored in the given 16-bit format and is
+ *        widened to floats as it is packed (B, C and the sums are floats)
+ */
+void gemmHalf(int m, int n, int k, const uint16_t *a, int lda, HalfFormat format, const float *b, int ldb,
+              float *c, int ldc);
+
+/**
+ * @fn gemv
+ * @brief computes y += A * x, where A is an m x n row-major matrix with a row stride of lda floats, x is a vector
+ *        of n floats and y is a vector of m floats. uses AVX2/FMA when the CPU supports them.
+ */
+void gemv(int m, int n, const float *a, int lda, const float *x, float *y);
+
+/**
+ * @fn gemvFused
+ * @brief computes y = epilogue(A * x + bias) in a single pass, where A is as in gemv and bias is a vector of m
+ *        floats (bias may be y itself).
+ * @return the sum of the outputs if epilogue is GemvExp (the softmax denominator), 0 otherwise
+ */
+float gemvFused(int m, int n, const float *a, int lda, const float *x, const float *bias, float *y,
+                GemvEpilogue epilogue);
+
+/**
+ * @fn gemvInt8Fused
+ * @brief the int8 version of gemvFused: computes y = epilogue(rowScales * xScale * (A * x) + bias), where A and x
+ *        are quantized (A is m x n with a row stride of lda, A[i][j] ~ A_real[i][j] / rowScales[i] and
+ *        x[j] ~ x_real[j] / xScale, all in [-127, 127]). the products are accumulated in 32-bit integers. uses
+ *        AVX2 when the CPU supports it.
+ * @return the sum of the outputs if epilogue is GemvExp, 0 otherwise
+ */
+float gemvInt8Fused(int m, int n, const int8_t *a, int lda, const float *rowScales, const int8_t *x, float xScale,
+                    const float *bias, float *y, GemvEpilogue epilogue);
+
+/**
+ * @fn gemvHalfFused
+ * @brief the 16-bit version of gemvFused: computes y = epilogue(A * x + bias), where A is stored in the given
+ *        16-bit format and is converted to floats as it is read (x, bias, y and the sums are floats). uses
+ *        AVX2/FMA (and F16C for Fp16) when the CPU supports them.
+ * @return the sum of the outputs if epilogue is GemvExp, 0 otherwise
+ */
+float gemvHalfFused(int m, int n, const uint16_t *a, int lda, HalfFormat format, const float *x, const float *bias,
+                    float *y, GemvEpilogue epilogue);
+
+/**
+ * @fn convertToHalf
+ * @brief converts n floats to the given 16-bit format, rounding to the nearest even value
+ */
+void convertToHalf(int n, const float *x, uint16_t *h, HalfFormat format);
+
+/**
+ * @fn convertFromHalf
+ * @brief converts n 16-bit values of the given format to floats
+ */
+void convertFromHalf(int n, const uint16_t *h, float *x, HalfFormat format);
+
+/**
+ * @fn quantizeInt8
+ * @brief quantizes n floats symmetrically with a single scale (x ~ scale * q), mapping the largest absolute
+ *        value to 127. uses AVX2 when the CPU supports it.
+ * @param q - output - the quantized values
+ * @return the scale (1 if all the values are 0)
+ */
+float quantizeInt8(int n, const float *x, int8_t *q);
+
+#endif //GEMM_H
@@ -0,0 +1,122 @@
+/**
+ * @file ImageStream.cpp
+ * @author Ron Shuvy
+ * @brief This file implements a reader of many images
+ */
+
+// ------------------------------ includes ------------------------------
+#include "ImageStream.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+// -------------------------- const definitions -------------------------
+#define ERROR_IMG "Error: invalid image path or size: "
+#define ERROR_PARTIAL_IMG "Error: the stream ends in the middle of an image"
+// ------------------------------ method definitions -----------------------------
+
+/**
+ * @fn open
+ * @brief lists a directory, reads a list, or opens a stream
+ */
+bool ImageStream::open(ImageSource source, const std::string &path, int pixels)
+{
+    _source = source, _pixels = pixels, _next = 0, _skipped = 0;
+    _paths.clear();
+    _file.close();
+    _stream = nullptr;
+    if (source == SourceDirectory)
+    {
+        std::error_code error;
+        for (const auto &entry : std::filesystem::directory_iterator(path, error))
+        {
+            if (entry.is_regular_file(error))
+            {
+                _paths.push_back(entry.path().string());
+            }
+        }
+        std::sort(_paths.begin(), _paths.end());
+        return !error;
+    }
+
+    if (source == SourceStream && path == STDIN_PATH)
+    {
+        _stream = &std::cin;
+        return true;
+    }
+    _file.open(path, source == SourceStream ? std::ios::in | std::ios::binary : std::ios::in);
+    if (!_file.is_open())
+    {
+        return false;
+    }
+    _stream = &_file;
+    std::string line;
+    while (source == SourceList && std::getline(_file, line))
+    {
+        if (!line.empty())
+        {
+            _paths.push_back(line);
+        }
+    }
+    return true;
+}
+
+/**
+ * @fn readFile
+ * @brief reads an image file into image
+ */
+bool ImageStream::readFile(const std::string &path, float *image) const
+{
+    std::ifstream is(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!is.is_open() || is.tellg() != (long)_pixels * (long)sizeof(float))
+    {
+        return false;
+    }
+    is.seekg(0, std::ios_base::beg);
+    return (bool)is.read((char *)image, (long)_pixels * (long)sizeof(float));
+}
+
+/**
+ * @fn read
+ * @brief reads the next images
+ */
+int ImageStream::read(float *images, int count, std::vector<std::string> &names)
+{
+    names.clear();
+    if (_source != SourceStream)
+    {
+        while ((int)names.size() < count && _next < _paths.size())
+        {
+            const std::string &path = _paths[_next++];
+            if (readFile(path, images + names.size() * _pixels))
+            {
+                names.push_back(path);
+            }
+            else
+            {
+                std::cerr << ERROR_IMG << path << std::endl;
+                ++_skipped;
+            }
+        }
+        return (int)names.size();
+    }
+
+    if (_stream == nullptr)
+    {
+        return 0;
+    }
+    // a single read of the whole chunk - the images are contiguous in the stream and in the buffer
+    long imageBytes = (long)_pixels * (long)sizeof(float);
+    _stream->read((char *)images, imageBytes * count);
+    long bytes = _stream->gcount();
+    int read = (int)(bytes / imageBytes);
+    if (bytes % imageBytes != 0)
+    {
+        std::cerr << ERROR_PARTIAL_IMG << std::endl;
+        ++_skipped;
+    }
+    for (int i = 0; i < read; ++i)
+    {
+        names.push_back(std::to_string(_next++));
+    }
+    return read;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file ImageStream.h
+ * @author Ron Shuvy
+ * @brief This header file defines a reader of many images, for classifying them in batches
+ */
+
+#ifndef IMAGESTREAM_H
+#define IMAGESTREAM_H
+// ------------------------------ includes ------------------------------
+#include <fstream>
+#include <string>
+#include <vector>
+// -------------------------- const definitions -------------------------
+#define STDIN_PATH "-" // the path of the standard input, for a stream source
+// ------------------------------ class declaration -----------------------------
+
+/**
+ * @enum ImageSource
+ * @brief where the images of an ImageStream come from
+ */
+enum ImageSource
+{
+    SourceDirectory, // every regular file of a directory (in the order of their names) is an image
+    SourceList, // a text file of image paths, one per line
+    SourceStream // a binary file (or the standard input) of images, one after the other
+};
+
+/**
+ * @class ImageStream
+ * @brief reads images of a fixed number of float pixels, a chunk at a time, into a caller-owned buffer. every
+ *        image has a name: its path, or its index in a stream.
+ */
+class ImageStream
+{
+private:
+    ImageSource _source;
+    int _pixels; // the floats of an image
+    std::vector<std::string> _paths; // the images of a directory or a list
+    size_t _next; // the index of the next path, or of the next image of a stream
+    std::ifstream _file; // the stream, unless it is the standard input
+    std::istream *_stream; // the stream which is read
+    int _skipped; // the paths which were not images of the right size
+
+    /**
+     * @fn readFile
+     * @brief reads an image file into image
+     * @return false if the file cannot be read, or its size is not an image
+     */
+    bool readFile(const std::string &path, float *image) const;
+
+public:
+    /**
+     * @fn Constructor
+     * @brief an empty stream - see open
+     */
+    ImageStream() : _source(SourceStream), _pixels(0), _next(0), _stream(nullptr), _skipped(0) {}
+
+    ImageStream(const ImageStream &) = delete;
+    ImageStream &operator=(const ImageStream &) = delete;
+
+    /**
+     * @fn open
+     * @brief lists a directory, reads a list, or opens a stream (STDIN_PATH for the standard input)
+     * @param pixels - the number of floats of an image
+     * @return false if the directory, list or stream cannot be opened
+     */
+    bool open(ImageSource source, const std::string &path, int pixels);
+
+    /**
+     * @fn read
+     * @brief reads the next images. a file which is not an image of the right size is skipped (with a message),
+     *        and so is a partial image at the end of a stream.
+     * @param images - output - count * pixels floats, the i-th image at images + i * pixels
+     * @param count - the largest number of images to read
+     * @param names - output - the names of the images which were read
+     * @return the number of images which were read, 0 at the end of the images
+     */
+    int read(float *images, int count, std::vector<std::string> &names);
+
+    /**
+     * @fn Getters
+     * @return the number of files (or partial images) which were skipped so far
+     */
+    int getSkipped() const { return _skipped; }
+};
+
+#endif //IMAGESTREAM_H
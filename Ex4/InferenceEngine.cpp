@@ -0,0 +1,81 @@
+/**
+ * @file InferenceEngine.cpp
+ * @author Ron Shuvy
+ * @brief This file implements a multi-threaded inference engine
+ */
+// ------------------------------ includes ------------------------------
+#include "InferenceEngine.h"
+#include <algorithm>
+// -------------------------- const definitions -------------------------
+#define ERROR_IMG_SIZE "Error: Illegal image size."
+#define ERROR_CHUNK_SIZE "Error: Chunk size should be a positive integer."
+// ------------------------------ method definitions -----------------------------
+
+/**
+ * @fn Constructor
+ */
+InferenceEngine::InferenceEngine(const MlpNetwork &mlp, int threads, int chunkSize)
+    : _mlp(mlp), _pool(threads), _scratch(_pool.size()), _chunkSize(chunkSize)
+{
+    if (chunkSize < 1)
+    {
+        std::cerr << ERROR_CHUNK_SIZE << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @fn classifyChunk
+ * @brief classifies images [first, last) on a worker
+ */
+void InferenceEngine::classifyChunk(int worker, const std::vector<Matrix> &images, int first, int last,
+                                    Digit digits[])
+{
+    Scratch &scratch = _scratch[worker];
+    int pixels = _mlp.getInputSize(), count = last - first;
+    if (scratch.batch.getRows() != pixels || scratch.batch.getCols() != count)
+    {
+        scratch.batch = Matrix(pixels, count);
+    }
+
+    // the j-th image is the j-th column of the batch
+    float *batch = scratch.batch.getData();
+    for (int p = 0; p < pixels; ++p)
+    {
+        for (int j = 0; j < count; ++j)
+        {
+            batch[p * count + j] = images[first + j].getData()[p];
+        }
+    }
+    _mlp.classifyBatch(scratch.batch, scratch.workspace, digits + first);
+}
+
+/**
+ * @fn classify
+ * @brief classifies images in parallel
+ */
+std::vector<Digit> InferenceEngine::classify(const std::vector<Matrix> &images)
+{
+    for (const Matrix &img : images)
+    {
+        if (img.getRows() * img.getCols() != _mlp.getInputSize())
+        {
+            std::cerr << ERROR_IMG_SIZE << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    std::vector<Digit> digits(images.size());
+    int count = (int)images.size();
+    for (int first = 0; first < count; first += _chunkSize)
+    {
+        int last = std::min(first + _chunkSize, count);
+        Digit *out = digits.data();
+        _pool.submit([this, &images, first, last, out](int worker)
+                     {
+                         classifyChunk(worker, images, first, last, out);
+                     });
+    }
+    _pool.wait();
+    return digits;
+}
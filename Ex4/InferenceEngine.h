@@ -0,0 +1,72 @@
+/**
+ * @file InferenceEngine.h
+ * @author Ron Shuvy
+ * @brief This header file defines a multi-threaded inference engine for an MlpNetwork
+ */
+
+#ifndef INFERENCEENGINE_H
+#define INFERENCEENGINE_H
+// ------------------------------ includes ------------------------------
+#include <vector>
+#include "Matrix.h"
+#include "Digit.h"
+#include "MlpNetwork.h"
+#include "ThreadPool.h"
+// -------------------------- const definitions -------------------------
+#define DEFAULT_CHUNK_SIZE 128 // images per task
+// ------------------------------ class declaration -----------------------------
+
+/**
+ * @class InferenceEngine
+ * @brief Classifies a stream of images on all cores. the images are split into chunks, and every chunk is a
+ *        batch (see MlpNetwork::classifyBatch) run by a worker of a work-stealing thread pool. the workers share
+ *        the read-only weights of the network, and each of them owns its scratch buffers.
+ */
+class InferenceEngine
+{
+private:
+    /**
+     * @struct Scratch
+     * @brief the buffers of a single worker, reused by all of its chunks
+     */
+    struct Scratch
+    {
+        Matrix batch; // the images of a chunk, one per column
+        Workspace workspace; // the outputs of the layers
+    };
+
+    const MlpNetwork &_mlp;
+    ThreadPool _pool;
+    std::vector<Scratch> _scratch; // a Scratch per worker
+    int _chunkSize;
+
+    /**
+     * @fn classifyChunk
+     * @brief classifies images [first, last) on a worker
+     */
+    void classifyChunk(int worker, const std::vector<Matrix> &images, int first, int last, Digit digits[]);
+
+public:
+    /**
+     * @fn Constructor
+     * @param mlp - the network (must outlive the engine)
+     * @param threads - number of worker threads (0 - the number of hardware threads)
+     * @param chunkSize - number of images in a task
+     */
+    explicit InferenceEngine(const MlpNetwork &mlp, int threads = 0, int chunkSize = DEFAULT_CHUNK_SIZE);
+
+    /**
+     * @fn Getters
+     */
+    int getThreads() const { return _pool.size(); }
+
+    /**
+     * @fn classify
+     * @brief classifies images in parallel. not reentrant (the workers' buffers are shared by the calls)
+     * @param images - images of digits (of the input size of the network each, in any shape)
+     * @return the identified digits, in the order of the images
+     */
+    std::vector<Digit> classify(const std::vector<Matrix> &images);
+};
+
+#endif //INFERENCEENGINE_H
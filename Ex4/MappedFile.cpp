@@ -0,0 +1,70 @@
+/**
+ * @file MappedFile.cpp
+ * @author Ron Shuvy
+ * @brief This file implements MappedFile class
+ */
+
+// ------------------------------ includes ------------------------------
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// ------------------------------ method definitions -----------------------------
+
+/**
+ * @fn open
+ * @brief maps a file
+ */
+bool MappedFile::open(const std::string &path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    // private and writable: writing to a view copies the page instead of changing the file
+    void *data = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file, so the descriptor is not needed anymore
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    _data = data, _size = (size_t)info.st_size;
+    return true;
+}
+
+/**
+ * @fn close
+ * @brief unmaps the file
+ */
+void MappedFile::close()
+{
+    if (_data != nullptr)
+    {
+        munmap(_data, _size);
+        _data = nullptr, _size = 0;
+    }
+}
+
+/**
+ * @fn view
+ * @brief views the floats of the file as a rows x cols matrix
+ */
+bool MappedFile::view(int rows, int cols, Matrix &mat) const
+{
+    if (_data == nullptr || rows <= 0 || cols <= 0 || _size != (size_t)rows * cols * sizeof(float))
+    {
+        return false;
+    }
+    mat = Matrix::view((float *)_data, rows, cols);
+    return true;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file MappedFile.h
+ * @author Ron Shuvy
+ * @brief This header file defines a memory-mapped file, whose floats can be used as a Matrix without copying
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+// ------------------------------ includes ------------------------------
+#include "Matrix.h"
+#include <string>
+// ------------------------------ class declaration -----------------------------
+
+/**
+ * @class MappedFile
+ * @brief maps a whole file into memory (private, copy-on-write): the pages are read from the page cache on
+ *        demand, and are shared by every process which maps the same file, as long as they are not written.
+ */
+class MappedFile
+{
+private:
+    void *_data; // the mapped file, null if no file is mapped
+    size_t _size; // the size of the file, in bytes
+
+public:
+    /**
+     * @fn Constructor
+     * @brief an empty mapping - see open
+     */
+    MappedFile() : _data(nullptr), _size(0) {}
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @fn Destructor
+     * @brief unmaps the file - views of it must not be used afterwards
+     */
+    ~MappedFile() { close(); }
+
+    /**
+     * @fn open
+     * @brief maps a file (unmapping the previous one)
+     * @return false if the file cannot be opened or mapped, or is empty
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @fn close
+     * @brief unmaps the file
+     */
+    void close();
+
+    /**
+     * @fn getSize
+     * @return the size of the file, in bytes
+     */
+    size_t getSize() const { return _size; }
+
+    /**
+     * @fn getData
+     * @return the mapped file, null if no file is mapped
+     */
+    char *getData() const { return (char *)_data; }
+
+    /**
+     * @fn view
+     * @brief views the floats of the file as a rows x cols matrix (no copy)
+     * @param mat - output - the view
+     * @return false if the size of the file is not rows * cols floats
+     */
+    bool view(int rows, int cols, Matrix &mat) const;
+};
+
+#endif //MAPPEDFILE_H
@@ -4,7 +4,10 @@
  * @brief This file implements a matrix class
  */
 // ------------------------------ includes ------------------------------
+#include <algorithm>
 #include "Matrix.h"
+#include "Gemm.h"
+#include "Workspace.h"
 // -------------------------- const definitions -------------------------
 #define EXIT_FAILURE 1
 #define MIN_SIZE 1
@@ -20,37 +23,78 @@
 //--------- Constructor ---------
 
 /**
- * @fn Constructor
+ * @brief exits if an allocation of elements failed
  */
-Matrix::Matrix(int rows, int cols)
+static float *checkAllocation(float *data)
+{
+    if (data == nullptr)
+    {
+        std::cerr << MEMORY_FAILURE << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return data;
+}
+
+/**
+ * @brief exits if the size of a matrix is not positive
+ */
+static void checkSize(int rows, int cols)
 {
-    // Validate input
     if (rows < MIN_SIZE || cols < MIN_SIZE)
     {
         std::cerr << ERROR_MAT_SIZE << std::endl;
         exit(EXIT_FAILURE);
     }
+}
+
+/**
+ * @fn Constructor
+ */
+Matrix::Matrix(int rows, int cols)
+{
+    // Validate input
+    checkSize(rows, cols);
 
     // Initialize matrix size
-    _rows = rows, _cols = cols;
-    _data = new (std::nothrow) float[rows * cols]();
+    _rows = rows, _cols = cols, _owner = true;
+    _data = checkAllocation(new (std::nothrow) float[rows * cols]);
+    std::fill(_data, _data + rows * cols, 0.0f);
+}
 
-    if (_data == nullptr)
-    {
-        std::cerr << MEMORY_FAILURE << std::endl;
-        exit(EXIT_FAILURE);
-    }
+/**
+ * @fn Constructor
+ * @brief a zero matrix of a workspace
+ */
+Matrix::Matrix(int rows, int cols, Workspace &workspace)
+{
+    checkSize(rows, cols);
+    _rows = rows, _cols = cols, _owner = false;
+    _data = checkAllocation(workspace.allocate((size_t)rows * cols));
+    std::fill(_data, _data + rows * cols, 0.0f);
 }
 
 /**
  * @fn Copy Constructor
  */
-Matrix::Matrix(const Matrix& m) : Matrix(m.getRows(), m.getCols())
+Matrix::Matrix(const Matrix& m) : _data(nullptr), _rows(0), _cols(0), _owner(true)
 {
-    for (int i = 0; i < _rows * _cols; ++i)
+    if (m._rows * m._cols == 0)
     {
-        _data[i] = m[i];
+        // a moved-from matrix is empty (0 x 0), and so is its copy
+        return;
     }
+    _rows = m._rows, _cols = m._cols;
+    _data = checkAllocation(new (std::nothrow) float[_rows * _cols]);
+    std::copy(m._data, m._data + _rows * _cols, _data);
+}
+
+/**
+ * @fn Move Constructor
+ */
+Matrix::Matrix(Matrix&& m) noexcept : _data(m._data), _rows(m._rows), _cols(m._cols), _owner(m._owner)
+{
+    m._data = nullptr;
+    m._rows = 0, m._cols = 0, m._owner = true;
 }
 
 /**
@@ -58,7 +102,24 @@ Matrix::Matrix(const Matrix& m) : Matrix(m.getRows(), m.getCols())
  */
 Matrix::~Matrix()
 {
-    delete[] _data;
+    if (_owner)
+    {
+        delete[] _data;
+    }
+}
+
+/**
+ * @fn view
+ * @brief a non-owning matrix over existing elements
+ */
+Matrix Matrix::view(float *data, int rows, int cols)
+{
+    if (rows < MIN_SIZE || cols < MIN_SIZE || data == nullptr)
+    {
+        std::cerr << ERROR_MAT_SIZE << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return Matrix(data, rows, cols);
 }
 
 //--------- Utilities ---------
@@ -130,45 +191,71 @@ Matrix& Matrix::operator=(const Matrix& b)
         Matrix &a = *this;
         if ((a._rows * a._cols) != (b._rows * b._cols))
         {
-            delete[] a._data;
-            a._data = new(std::nothrow) float[b._rows * b._cols];
-            if (a._data == nullptr)
+            // a view of a different size gets elements of its own
+            if (a._owner)
             {
-                std::cerr << MEMORY_FAILURE << std::endl;
-                exit(EXIT_FAILURE);
+                delete[] a._data;
             }
+            a._data = checkAllocation(new (std::nothrow) float[b._rows * b._cols]);
+            a._owner = true;
         }
         a._rows = b._rows, a._cols = b._cols;
-        for (int i = 0; i < a._rows * a._cols; ++i)
-        {
-            a[i] = b[i];
-        }
+        std::copy(b._data, b._data + b._rows * b._cols, a._data);
     }
     return *this;
 }
 
 /**
- * @fn operator *
- * @brief Matrix multiplication
+ * @fn operator =
+ * @brief move assigment
  */
-Matrix operator*(const Matrix& a, const Matrix& b)
+Matrix& Matrix::operator=(Matrix&& b) noexcept
+{
+    // b frees the previous elements of this matrix
+    std::swap(_data, b._data);
+    std::swap(_rows, b._rows);
+    std::swap(_cols, b._cols);
+    std::swap(_owner, b._owner);
+    return *this;
+}
+
+/**
+ * @fn multiplyInto
+ * @brief Matrix multiplication into an existing matrix
+ */
+void multiplyInto(Matrix& dst, const Matrix& a, const Matrix& b)
 {
     if (a._cols != b._rows)
     {
         std::cerr << ERROR_MAT_MULT << std::endl;
         exit(EXIT_FAILURE);
     }
-    Matrix mult(a._rows, b._cols);
-    for(int i = 0; i < a._rows; ++i)
+    if (dst._rows * dst._cols != a._rows * b._cols)
     {
-        for(int j = 0; j < b._cols; ++j)
-        {
-            for (int k = 0; k < a._cols; ++k)
-            {
-                mult(i, j) += a(i, k) * b(k, j);
-            }
-        }
+        dst = Matrix(a._rows, b._cols);
+    }
+    else
+    {
+        std::fill(dst._data, dst._data + dst._rows * dst._cols, 0.0f);
     }
+    dst._rows = a._rows, dst._cols = b._cols;
+    if (b._cols == 1)
+    {
+        // matrix-vector product (e.g. a Dense layer applied to an image)
+        gemv(a._rows, a._cols, a._data, a._cols, b._data, dst._data);
+        return;
+    }
+    gemm(a._rows, b._cols, a._cols, a._data, a._cols, b._data, b._cols, dst._data, dst._cols);
+}
+
+/**
+ * @fn operator *
+ * @brief Matrix multiplication
+ */
+Matrix operator*(const Matrix& a, const Matrix& b)
+{
+    Matrix mult(a._rows, b._cols);
+    multiplyInto(mult, a, b);
     return mult;
 }
 
@@ -200,13 +287,51 @@ Matrix operator+(const Matrix& a, const Matrix& b)
         std::cerr << ERROR_MAT_ADD << std::endl;
         exit(EXIT_FAILURE);
     }
-    Matrix sum(a._rows, a._cols);
-    for(int i = 0; i < a._rows; ++i)
+    Matrix sum = a;
+    sum += b;
+    return sum;
+}
+
+/**
+ * @fn multiply
+ * @brief Matrix multiplication into a matrix of a workspace
+ */
+Matrix multiply(const Matrix& a, const Matrix& b, Workspace& workspace)
+{
+    Matrix mult(a._rows, b._cols, workspace);
+    multiplyInto(mult, a, b);
+    return mult;
+}
+
+/**
+ * @fn multiply
+ * @brief Multiplication by a scalar into a matrix of a workspace
+ */
+Matrix multiply(const Matrix& m, const float c, Workspace& workspace)
+{
+    Matrix res(m._rows, m._cols, workspace);
+    for (int i = 0; i < m._rows * m._cols; ++i)
+    {
+        res._data[i] = m._data[i] * c;
+    }
+    return res;
+}
+
+/**
+ * @fn add
+ * @brief Matrix addition into a matrix of a workspace
+ */
+Matrix add(const Matrix& a, const Matrix& b, Workspace& workspace)
+{
+    if (a._cols != b._cols || a._rows != b._rows)
+    {
+        std::cerr << ERROR_MAT_ADD << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    Matrix sum(a._rows, a._cols, workspace);
+    for (int i = 0; i < a._rows * a._cols; ++i)
     {
-        for(int j = 0; j < a._cols; ++j)
-        {
-            sum(i, j) = a(i, j) + b(i, j);
-        }
+        sum._data[i] = a._data[i] + b._data[i];
     }
     return sum;
 }
@@ -224,12 +349,9 @@ Matrix& Matrix::operator+=(const Matrix& b)
         exit(EXIT_FAILURE);
     }
 
-    for(int i = 0; i < a._rows; ++i)
+    for (int i = 0; i < a._rows * a._cols; ++i)
     {
-        for(int j = 0; j < a._cols; ++j)
-        {
-            a(i, j) += b(i, j);
-        }
+        a._data[i] += b._data[i];
     }
     return a;
 }
@@ -258,14 +380,12 @@ std::ostream& operator<<(std::ostream &out, const Matrix &m)
  */
 void operator>>(std::istream &is, const Matrix &m)
 {
-    for (int i = 0; i < m.getRows()* m.getCols(); ++i)
+    // a single read of all the elements
+    is.read((char *) m._data, (std::streamsize) m.getRows() * m.getCols() * sizeof(float));
+    if (! is.good())
     {
-        is.read((char *) &(m[i]), sizeof(float));
-        if (! is.good())
-        {
-            std::cerr << ERROR_READING << std::endl;
-            exit(EXIT_FAILURE);
-        }
+        std::cerr << ERROR_READING << std::endl;
+        exit(EXIT_FAILURE);
     }
     if (is.peek() != EOF)
     {
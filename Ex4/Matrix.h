@@ -11,6 +11,8 @@
 // -------------------------- const definitions -------------------------
 #define BASIC_MAT_SIZE 1
 // ------------------------------ class declaration -----------------------------
+class Workspace;
+
 /**
  * @struct MatrixDims
  * @brief Matrix dimensions container
@@ -29,13 +31,29 @@ class Matrix
 private:
     float *_data; // Matrix elements
     int _rows, _cols; // Matrix size
+    bool _owner; // whether the matrix frees its elements - false for a view, or elements of a Workspace
+
+    /**
+     * @fn Constructor
+     * @brief a view of existing elements
+     */
+    Matrix(float *data, int rows, int cols) : _data(data), _rows(rows), _cols(cols), _owner(false) {}
 
 public:
     /**
      * @fn Constructor
+     * @brief a zero matrix, whose elements come from the heap
      */
     Matrix(int rows, int cols);
 
+    /**
+     * @fn Constructor
+     * @brief a zero matrix, whose elements come from a workspace. the matrix does not free them, and must not be
+     *        used after they are released (see WorkspaceScope). a copy of the matrix, or a matrix of a different
+     *        size assigned to it, takes elements from the heap.
+     */
+    Matrix(int rows, int cols, Workspace &workspace);
+
     /**
      * @fn Default Constructor
      */
@@ -43,14 +61,36 @@ public:
 
     /**
      * @fn Copy Constructor
+     * @brief an owning copy of the elements of m (a copy of an empty, moved-from matrix is empty as well)
      */
     Matrix(const Matrix &m);
 
+    /**
+     * @fn Move Constructor
+     * @brief takes the elements of m, which is left empty (0 x 0)
+     */
+    Matrix(Matrix &&m) noexcept;
+
     /**
      * @fn Destructor
      */
     ~Matrix();
 
+    /**
+     * @fn view
+     * @brief a non-owning matrix over rows * cols existing floats (e.g. a memory-mapped file), which must outlive
+     *        the view. the elements are not copied, and are not freed by the view. writing to the view writes to
+     *        the viewed floats, a copy of a view is an owning matrix, and so is a view which is assigned a matrix of
+     *        a different size.
+     */
+    static Matrix view(float *data, int rows, int cols);
+
+    /**
+     * @fn isView
+     * @return whether the matrix does not own its elements (a view, or a matrix of a workspace)
+     */
+    bool isView() const { return !_owner; }
+
     /**
     * @fn Getters
     */
@@ -59,6 +99,15 @@ public:
     * @fn Getters
     */
     int getCols() const { return _cols; }
+    /**
+    * @fn Getters
+    * @brief the elements of the matrix (row-major), for kernels which cannot afford bounds checks
+    */
+    float* getData() { return _data; }
+    /**
+    * @fn Getters
+    */
+    const float* getData() const { return _data; }
 
     /**
      * @fn vectorize
@@ -76,6 +125,11 @@ public:
      * @brief copy assigment
      */
     Matrix& operator=(const Matrix& b);
+    /**
+     * @fn operator =
+     * @brief move assigment
+     */
+    Matrix& operator=(Matrix&& b) noexcept;
     /**
      * @fn operator +=
      * @brief Addition assignment
@@ -86,6 +140,12 @@ public:
      * @brief Matrix multiplication
      */
     friend Matrix operator*(const Matrix& a, const Matrix& b);
+    /**
+     * @fn multiplyInto
+     * @brief Matrix multiplication into an existing matrix: dst = a * b. dst is reallocated only if its
+     *        size is different from the size of the result, and must not be a or b.
+     */
+    friend void multiplyInto(Matrix& dst, const Matrix& a, const Matrix& b);
     /**
      * @fn operator *
      * @brief Multiplication between lhs=matrix and rhs=scalar
@@ -101,6 +161,21 @@ public:
      * @brief Matrix addition
      */
     friend Matrix operator+(const Matrix& a, const Matrix& b);
+    /**
+     * @fn multiply
+     * @brief Matrix multiplication, as operator*, into a matrix of a workspace (see Matrix(rows, cols, workspace))
+     */
+    friend Matrix multiply(const Matrix& a, const Matrix& b, Workspace& workspace);
+    /**
+     * @fn multiply
+     * @brief Multiplication by a scalar, as operator*, into a matrix of a workspace
+     */
+    friend Matrix multiply(const Matrix& m, float c, Workspace& workspace);
+    /**
+     * @fn add
+     * @brief Matrix addition, as operator+, into a matrix of a workspace
+     */
+    friend Matrix add(const Matrix& a, const Matrix& b, Workspace& workspace);
     /**
      * @fn operator ()
      * @brief access entry (i,j) in matrix
@@ -5,23 +5,80 @@
  */
 // ------------------------------ includes ------------------------------
 #include "MlpNetwork.h"
+#include <algorithm>
+// -------------------------- const definitions -------------------------
+#define ERROR_LAYERS "Error: the layers of the network do not fit together."
 // ------------------------------ method definitions -----------------------------
 /**
  * @brief This functions finds the top-rated digit and return its value and its probability
+ * @param result - the network output, one column per input
+ * @param col - the column of the input
  */
-Digit findDigit(const Matrix& result)
+Digit findDigit(const Matrix& result, int col = 0)
 {
-    Digit d = {0, result[0]};
-    for (int i = 1; i < result.getCols() * result.getRows(); ++i)
+    const float *data = result.getData();
+    int cols = result.getCols();
+    Digit d = {0, data[col]};
+    for (int i = 1; i < result.getRows(); ++i)
     {
-        if (result[i] > d.probability)
+        if (data[i * cols + col] > d.probability)
         {
-            d.probability = result[i], d.value = i;
+            d.probability = data[i * cols + col], d.value = i;
         }
     }
     return d;
 }
 
+/**
+ * @fn Constructor
+ */
+MlpNetwork::MlpNetwork(const Matrix weights[], const Matrix biases[], const ActivationType activations[],
+                       int layerCount)
+    : _maxRows(0), _pool(nullptr)
+{
+    if (layerCount <= 0)
+    {
+        std::cerr << ERROR_LAYERS << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    _layers.reserve(layerCount);
+    for (int i = 0; i < layerCount; ++i)
+    {
+        if (biases[i].getRows() != weights[i].getRows() || biases[i].getCols() != 1 ||
+            (i > 0 && weights[i].getCols() != weights[i - 1].getRows()))
+        {
+            std::cerr << ERROR_LAYERS << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        _layers.emplace_back(&weights[i], &biases[i], activations[i]);
+        _maxRows = std::max(_maxRows, weights[i].getRows());
+    }
+    // a first run of the buffers, so operator() finds the workspace large enough
+    WorkspaceScope scope(_workspace);
+    Matrix first(_maxRows, 1, _workspace), second(_maxRows, 1, _workspace);
+}
+
+/**
+ * @fn forward
+ * @brief runs the layers on the columns of input, in ping-pong buffers of the workspace
+ */
+Matrix MlpNetwork::forward(const Matrix &input, Workspace &workspace, bool quantized, ThreadPool *pool) const
+{
+    int cols = input.getCols();
+    Matrix buffers[2] = {Matrix(_maxRows, cols, workspace), Matrix(_maxRows, cols, workspace)};
+
+    // each output is a view of the buffer of its layer, so the layers never reallocate it
+    Matrix x = Matrix::view(buffers[0].getData(), _layers[0].getRows(), cols);
+    quantized ? _quantized[0].apply(input, x) : _layers[0].apply(input, x, pool);
+    for (int i = 1; i < getLayerCount(); ++i)
+    {
+        Matrix out = Matrix::view(buffers[i % 2].getData(), _layers[i].getRows(), cols);
+        quantized ? _quantized[i].apply(x, out) : _layers[i].apply(x, out, pool);
+        x = std::move(out);
+    }
+    return x;
+}
+
 /**
  * @fn operator ()
  * @param img - an image of a digit coded to matrix representation
@@ -29,11 +86,94 @@ Digit findDigit(const Matrix& result)
  */
 Digit MlpNetwork::operator()(const Matrix &img) const
 {
-    Matrix result = img;
-    for (int i = 0; i < MLP_SIZE - 1; ++i)
+    WorkspaceScope scope(_workspace);
+    return findDigit(forward(img, _workspace, isQuantized(), _pool));
+}
+
+/**
+ * @fn quantize
+ * @brief switches operator() to int8 inference
+ */
+void MlpNetwork::quantize()
+{
+    if (isQuantized())
+    {
+        return;
+    }
+    _quantized.reserve(_layers.size());
+    for (const Dense &layer : _layers)
+    {
+        _quantized.emplace_back(layer);
+    }
+}
+
+/**
+ * @fn storeHalf
+ * @brief replaces the weights of the layers by a 16-bit copy of them
+ */
+void MlpNetwork::storeHalf(HalfFormat format)
+{
+    for (Dense &layer : _layers)
+    {
+        layer.storeHalf(format);
+    }
+}
+
+/**
+ * @fn getWeightsBytes
+ * @return the size of the weights (and biases) the network keeps in memory, in bytes
+ */
+size_t MlpNetwork::getWeightsBytes() const
+{
+    size_t bytes = 0;
+    for (int i = 0; i < getLayerCount(); ++i)
+    {
+        size_t biasBytes = (size_t)_layers[i].getBias().getRows() * sizeof(float);
+        bytes += biasBytes + _layers[i].getWeightsBytes() + (isQuantized() ? _quantized[i].getWeightsBytes() : 0);
+    }
+    return bytes;
+}
+
+/**
+ * @fn getReadBytes
+ * @return the size of the weights (and biases) operator() reads for an image, in bytes
+ */
+size_t MlpNetwork::getReadBytes() const
+{
+    size_t bytes = 0;
+    for (int i = 0; i < getLayerCount(); ++i)
+    {
+        size_t biasBytes = (size_t)_layers[i].getBias().getRows() * sizeof(float);
+        bytes += biasBytes + (isQuantized() ? _quantized[i].getWeightsBytes() : _layers[i].getReadBytes());
+    }
+    return bytes;
+}
+
+/**
+ * @fn classifyBatch
+ * @param images - a matrix whose columns are images
+ * @return the identified digits
+ */
+std::vector<Digit> MlpNetwork::classifyBatch(const Matrix &images) const
+{
+    Workspace workspace;
+    std::vector<Digit> digits(images.getCols());
+    classifyBatch(images, workspace, digits.data());
+    return digits;
+}
+
+/**
+ * @fn classifyBatch
+ * @param images - a matrix whose columns are images
+ * @param workspace - the memory of the layer outputs
+ * @param digits - output - the identified digits
+ */
+void MlpNetwork::classifyBatch(const Matrix &images, Workspace &workspace, Digit digits[]) const
+{
+    WorkspaceScope scope(workspace);
+    Matrix result = forward(images, workspace, false, nullptr);
+    for (int j = 0; j < images.getCols(); ++j)
     {
-        result = Dense(_weights[i], _biases[i], Relu)(result);
+        digits[j] = findDigit(result, j);
     }
-    result = Dense(_weights[MLP_SIZE-1], _biases[MLP_SIZE-1], Softmax)(result);
-    return findDigit(result);
 }
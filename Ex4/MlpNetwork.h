@@ -11,35 +11,148 @@
 #include "Matrix.h"
 #include "Digit.h"
 #include "Dense.h"
+#include "QuantizedDense.h"
+#include "ModelFile.h"
+#include "Workspace.h"
+#include <vector>
 // -------------------------- const definitions -------------------------
+// the layout of the default model (the w1..w4, b1..b4 parameters files)
 #define MLP_SIZE 4
-const MatrixDims imgDims = {28, 28};
-const MatrixDims weightsDims[] = {{128, 784}, {64, 128}, {20, 64}, {10, 20}};
-const MatrixDims biasDims[]    = {{128, 1}, {64, 1}, {20, 1},  {10, 1}};
+constexpr MatrixDims imgDims = {28, 28};
+constexpr MatrixDims weightsDims[] = {{128, 784}, {64, 128}, {20, 64}, {10, 20}};
+constexpr MatrixDims biasDims[]    = {{128, 1}, {64, 1}, {20, 1},  {10, 1}};
+constexpr ActivationType defaultActivations[] = {Relu, Relu, Relu, Softmax};
 // ------------------------------ class declaration -----------------------------
 
 /**
  * @class MlpNetwork
- * @brief This class contains the complete mlp network
+ * @brief This class contains the complete mlp network - any number of Dense layers, each with its own activation
  */
 class MlpNetwork
 {
 private:
-    const Matrix* _weights; // array of weights
-    const Matrix* _biases; // array of biases
+    std::vector<Dense> _layers; // the layers, built once (they refer to the weights and biases)
+    std::vector<QuantizedDense> _quantized; // the int8 layers, used by operator() once quantize() is called
+    int _maxRows; // the size of the largest layer output
+    mutable Workspace _workspace; // the layer outputs of operator(), warmed up by the constructor
+    ThreadPool *_pool; // if not null, operator() splits the large layers across the pool's workers
+
+    /**
+     * @fn forward
+     * @brief runs the layers on the columns of input, in two ping-pong buffers of the workspace: layer i writes
+     *        its output to buffer i % 2 and reads the output of layer i - 1 from the other one, so two buffers of
+     *        the largest layer serve any depth
+     * @return the output of the last layer, valid until the caller releases the workspace
+     */
+    Matrix forward(const Matrix &input, Workspace &workspace, bool quantized, ThreadPool *pool) const;
 
 public:
     /**
      * @fn Constructor
+     * @brief a network of layerCount layers: layer i multiplies by weights[i], adds biases[i] and applies
+     *        activations[i]. the weights and biases are not copied, and must outlive the network. exits if the
+     *        layers do not fit together.
+     */
+    MlpNetwork(const Matrix weights[], const Matrix biases[], const ActivationType activations[], int layerCount);
+
+    /**
+     * @fn Constructor
+     * @brief a network of the default layout (MLP_SIZE layers, defaultActivations)
+     */
+    MlpNetwork(const Matrix weights[], const Matrix biases[])
+        : MlpNetwork(weights, biases, defaultActivations, MLP_SIZE) {}
+
+    /**
+     * @fn Constructor
+     * @brief a network of the layers of a model file, which must stay open while the network is used
+     */
+    explicit MlpNetwork(const ModelFile &model)
+        : MlpNetwork(model.getWeights(), model.getBiases(), model.getActivations(), model.getLayerCount()) {}
+
+    /**
+     * @fn Getters
+     */
+    int getLayerCount() const { return (int)_layers.size(); }
+    /**
+     * @fn Getters
+     * @brief the size of an input (a column vector)
      */
-    MlpNetwork(const Matrix weights[], const Matrix biases[]) : _weights(weights), _biases(biases) {};
+    int getInputSize() const { return _layers.front().getCols(); }
 
     /**
      * @fn operator ()
+     * @brief runs the network without allocating memory (unless a thread pool is set). not thread-safe (the layer
+     *        outputs are shared)
      * @param img - an image of a digit coded to matrix representation
      * @return the identified digit with its probability
      */
     Digit operator()(const Matrix &img) const;
 
+    /**
+     * @fn setThreadPool
+     * @brief sets a persistent pool, which operator() uses to split each large layer across the calling thread
+     *        and the pool's workers (for single-image latency). the pool must outlive the network.
+     * @param pool - the pool, null to run operator() on the calling thread only
+     */
+    void setThreadPool(ThreadPool *pool) { _pool = pool; }
+
+    /**
+     * @fn quantize
+     * @brief switches operator() to int8 inference: the weights of every layer are quantized with a scale per
+     *        row, and the input of every layer with a scale of its own. an image reads 4 times fewer weight
+     *        bytes, at the cost of a small error in the probabilities. the int8 weights are an additional copy -
+     *        classifyBatch still uses the weights of the layers, so the network keeps both (see getWeightsBytes).
+     */
+    void quantize();
+
+    /**
+     * @fn storeHalf
+     * @brief replaces the weights of every layer by a 16-bit copy of them (Fp16 or Bf16), converted to fp32 as
+     *        they are read - half of the weight bytes an image reads and the network keeps, with almost no loss
+     *        of accuracy (classifyBatch uses the copy too). the network stops referring to the fp32 weights, so
+     *        the caller may release them (the biases must still outlive it). a quantized network keeps using its
+     *        int8 layers for operator().
+     */
+    void storeHalf(HalfFormat format);
+
+    /**
+     * @fn isQuantized
+     * @return whether operator() runs the int8 layers
+     */
+    bool isQuantized() const { return !_quantized.empty(); }
+
+    /**
+     * @fn getWeightsBytes
+     * @return the size of the weights (and biases) the network keeps in memory, in bytes - the fp32 weights (or
+     *         the 16-bit ones once storeHalf() is called), and the int8 copy once quantize() is called
+     */
+    size_t getWeightsBytes() const;
+
+    /**
+     * @fn getReadBytes
+     * @return the size of the weights (and biases) operator() reads for an image, in bytes
+     */
+    size_t getReadBytes() const;
+
+    /**
+     * @fn classifyBatch
+     * @brief runs the network on a batch of images at once - every layer is a single matrix product over the
+     *        batch, so each weight is read once per batch instead of once per image. thread-safe.
+     * @param images - a (rows x cols of an image) x B matrix, whose j-th column is the j-th image
+     * @return the identified digits, in the order of the columns
+     */
+    std::vector<Digit> classifyBatch(const Matrix &images) const;
+
+    /**
+     * @fn classifyBatch
+     * @brief as classifyBatch(images), with the layer outputs allocated from a caller-owned workspace (and
+     *        released before returning), so a workspace which is reused by every batch stops allocating from the
+     *        heap once it fits the largest batch. thread-safe, as long as each thread has its own workspace.
+     * @param images - a matrix whose columns are images
+     * @param workspace - the memory of the layer outputs
+     * @param digits - output - the identified digits, in the order of the columns
+     */
+    void classifyBatch(const Matrix &images, Workspace &workspace, Digit digits[]) const;
+
 };
 #endif // MLPNETWORK_H
@@ -0,0 +1,127 @@
+/**
+ * @file ModelFile.cpp
+ * @author Ron Shuvy
+ * @brief This file implements the model file format
+ */
+
+// ------------------------------ includes ------------------------------
+#include "ModelFile.h"
+#include <cstring>
+#include <fstream>
+// ------------------------------ functions -----------------------------
+
+/**
+ * @brief rounds an offset up to a multiple of MODEL_ALIGNMENT
+ */
+static uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + MODEL_ALIGNMENT - 1) / MODEL_ALIGNMENT * MODEL_ALIGNMENT;
+}
+
+/**
+ * @brief checks that a blob of count floats is aligned and inside the file
+ */
+static bool validBlob(uint64_t offset, uint64_t count, size_t fileSize)
+{
+    return offset % MODEL_ALIGNMENT == 0 && offset <= fileSize && count * sizeof(float) <= fileSize - offset;
+}
+
+/**
+ * @fn open
+ * @brief maps a model file, and checks it
+ */
+bool ModelFile::open(const std::string &path)
+{
+    _weights.clear(), _biases.clear(), _activations.clear();
+    if (!_file.open(path) || _file.getSize() < sizeof(ModelHeader))
+    {
+        return false;
+    }
+    ModelHeader header;
+    std::memcpy(&header, _file.getData(), sizeof(header));
+    if (std::memcmp(header.magic, MODEL_MAGIC, MODEL_MAGIC_SIZE) != 0 || header.version != MODEL_VERSION ||
+        header.dtype != ModelFloat32 || header.layerCount == 0 ||
+        header.layerCount > (_file.getSize() - sizeof(ModelHeader)) / sizeof(ModelLayerInfo))
+    {
+        _file.close();
+        return false;
+    }
+
+    const char *table = _file.getData() + sizeof(ModelHeader);
+    for (uint32_t i = 0; i < header.layerCount; ++i)
+    {
+        ModelLayerInfo layer;
+        std::memcpy(&layer, table + i * sizeof(ModelLayerInfo), sizeof(layer));
+        bool valid = layer.rows > 0 && layer.rows <= INT32_MAX && layer.cols > 0 && layer.cols <= INT32_MAX &&
+                     (layer.activation == Relu || layer.activation == Softmax) &&
+                     (i == 0 || (int)layer.cols == _weights.back().getRows()) &&
+                     validBlob(layer.weightsOffset, (uint64_t)layer.rows * layer.cols, _file.getSize()) &&
+                     validBlob(layer.biasOffset, layer.rows, _file.getSize());
+        if (!valid)
+        {
+            _weights.clear(), _biases.clear(), _activations.clear();
+            _file.close();
+            return false;
+        }
+        _weights.push_back(Matrix::view((float *)(_file.getData() + layer.weightsOffset), layer.rows, layer.cols));
+        _biases.push_back(Matrix::view((float *)(_file.getData() + layer.biasOffset), layer.rows, 1));
+        _activations.push_back((ActivationType)layer.activation);
+    }
+    return true;
+}
+
+/**
+ * @brief writes a blob at its offset, padding the file from its current end
+ */
+static void writeBlob(std::ofstream &out, uint64_t offset, const Matrix &mat)
+{
+    static const char padding[MODEL_ALIGNMENT] = {};
+    out.write(padding, (std::streamsize)(offset - (uint64_t)out.tellp()));
+    out.write((const char *)mat.getData(), (std::streamsize)mat.getRows() * mat.getCols() * sizeof(float));
+}
+
+/**
+ * @fn writeModelFile
+ * @brief writes layers to a model file
+ */
+bool writeModelFile(const std::string &path, const Matrix weights[], const Matrix biases[],
+                    const ActivationType activations[], int layerCount)
+{
+    if (layerCount <= 0)
+    {
+        return false;
+    }
+    ModelHeader header = {};
+    std::memcpy(header.magic, MODEL_MAGIC, MODEL_MAGIC_SIZE);
+    header.version = MODEL_VERSION, header.layerCount = (uint32_t)layerCount, header.dtype = ModelFloat32;
+
+    std::vector<ModelLayerInfo> layers(layerCount);
+    uint64_t offset = sizeof(ModelHeader) + layerCount * sizeof(ModelLayerInfo);
+    for (int i = 0; i < layerCount; ++i)
+    {
+        if (biases[i].getRows() != weights[i].getRows() || biases[i].getCols() != 1 ||
+            (i > 0 && weights[i].getCols() != weights[i - 1].getRows()))
+        {
+            return false;
+        }
+        ModelLayerInfo &layer = layers[i];
+        layer = {};
+        layer.rows = (uint32_t)weights[i].getRows(), layer.cols = (uint32_t)weights[i].getCols();
+        layer.activation = activations[i];
+        layer.weightsOffset = alignOffset(offset);
+        offset = layer.weightsOffset + (uint64_t)layer.rows * layer.cols * sizeof(float);
+        layer.biasOffset = alignOffset(offset);
+        offset = layer.biasOffset + layer.rows * sizeof(float);
+    }
+
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write((const char *)&header, sizeof(header));
+    out.write((const char *)layers.data(), (std::streamsize)(layerCount * sizeof(ModelLayerInfo)));
+    for (int i = 0; i < layerCount; ++i)
+    {
+        writeBlob(out, layers[i].weightsOffset, weights[i]);
+        writeBlob(out, layers[i].biasOffset, biases[i]);
+    }
+    out.close();
+    return out.good();
+}
@@ -0,0 +1,120 @@
+/**
+ * @file ModelFile.h
+ * @author Ron Shuvy
+ * @brief This header file defines a single-file format of an mlp model, which is used in place after mmap
+ *
+ * A model file is a ModelHeader, followed by a ModelLayerInfo per layer, followed by the weights (row-major) and
+ * the bias of each layer. every blob starts at an offset which is a multiple of MODEL_ALIGNMENT, so the mapped
+ * weights are aligned for the SIMD kernels. the fields and floats are stored in the byte order of the machine
+ * (little-endian on x86).
+ */
+
+#ifndef MODELFILE_H
+#define MODELFILE_H
+// ------------------------------ includes ------------------------------
+#include "Matrix.h"
+#include "Activation.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+// -------------------------- const definitions -------------------------
+#define MODEL_MAGIC "MLPMODEL"
+#define MODEL_MAGIC_SIZE 8
+#define MODEL_VERSION 1
+#define MODEL_ALIGNMENT 64 // bytes - a cache line
+// ------------------------------ type definitions -----------------------------
+
+/**
+ * @enum ModelDtype
+ * @brief the type of the elements of the weights and biases
+ */
+enum ModelDtype
+{
+    ModelFloat32
+};
+
+/**
+ * @struct ModelHeader
+ * @brief the start of a model file
+ */
+typedef struct ModelHeader
+{
+    char magic[MODEL_MAGIC_SIZE]; // MODEL_MAGIC, without a terminating null
+    uint32_t version; // MODEL_VERSION
+    uint32_t layerCount;
+    uint32_t dtype; // a ModelDtype
+    uint32_t reserved; // 0
+} ModelHeader;
+
+/**
+ * @struct ModelLayerInfo
+ * @brief the description of a layer: the weights are rows x cols, and the bias is rows x 1
+ */
+typedef struct ModelLayerInfo
+{
+    uint32_t rows, cols;
+    uint32_t activation; // an ActivationType
+    uint32_t reserved; // 0
+    uint64_t weightsOffset, biasOffset; // from the start of the file
+} ModelLayerInfo;
+
+static_assert(sizeof(ModelHeader) == 24 && sizeof(ModelLayerInfo) == 32, "the model file layout must be packed");
+
+// ------------------------------ class declaration -----------------------------
+
+/**
+ * @class ModelFile
+ * @brief a mapped model file, whose weights and biases are matrix views of the mapping (no copy)
+ */
+class ModelFile
+{
+private:
+    MappedFile _file;
+    std::vector<Matrix> _weights, _biases; // views of the mapping
+    std::vector<ActivationType> _activations;
+
+public:
+    /**
+     * @fn open
+     * @brief maps a model file, and checks its header and the bounds and alignment of every layer
+     * @return false if the file cannot be mapped or is not a valid model
+     */
+    bool open(const std::string &path);
+
+    /**
+     * @fn getLayerCount
+     */
+    int getLayerCount() const { return (int)_weights.size(); }
+
+    /**
+     * @fn Getters
+     * @brief the weights of the layers, in order (valid while the file is open)
+     */
+    const Matrix *getWeights() const { return _weights.data(); }
+
+    /**
+     * @fn Getters
+     * @brief the biases of the layers, in order (valid while the file is open)
+     */
+    const Matrix *getBiases() const { return _biases.data(); }
+
+    /**
+     * @fn Getters
+     * @brief the activations of the layers, in order
+     */
+    const ActivationType *getActivations() const { return _activations.data(); }
+};
+
+/**
+ * @fn writeModelFile
+ * @brief writes layers to a model file
+ * @param weights - the weights of each layer
+ * @param biases - the bias of each layer (a column vector with a row per row of the weights)
+ * @param activations - the activation of each layer
+ * @return false if the layers do not fit together or the file cannot be written
+ */
+bool writeModelFile(const std::string &path, const Matrix weights[], const Matrix biases[],
+                    const ActivationType activations[], int layerCount);
+
+#endif //MODELFILE_H
@@ -0,0 +1,55 @@
+/**
+ * @file QuantizedDense.cpp
+ * @author Ron Shuvy
+ * @brief This file implements QuantizedDense class
+ */
+
+// ------------------------------ includes ------------------------------
+#include "QuantizedDense.h"
+#include "Gemm.h"
+#include <cstdlib>
+// ------------------------------ method definitions -----------------------------
+
+/**
+ * @fn Constructor
+ */
+QuantizedDense::QuantizedDense(const Dense &dense)
+    : _act(dense.getActivation()), _rows(dense.getRows()), _cols(dense.getCols()),
+      _weights((size_t)_rows * _cols), _scales(_rows), _bias(&dense.getBias()), _input(_cols)
+{
+    std::vector<float> buffer(_cols); // a row of 16-bit weights, widened to floats
+    for (int i = 0; i < _rows; ++i)
+    {
+        const float *row = dense.getWeightsRow(i, buffer.data());
+        _scales[i] = quantizeInt8(_cols, row, _weights.data() + (size_t)i * _cols);
+    }
+}
+
+/**
+ * @fn apply
+ * @brief calculates the result of the layer for a single input into out
+ */
+void QuantizedDense::apply(const Matrix &x, Matrix &out) const
+{
+    if (x.getRows() != _cols || x.getCols() != 1 || _bias->getRows() != _rows || _bias->getCols() != 1)
+    {
+        std::cerr << "Error: illegal input to a quantized layer" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (out.getRows() != _rows || out.getCols() != 1)
+    {
+        out = Matrix(_rows, 1);
+    }
+    bool softmax = (_act.getActivationType() == Softmax);
+    float xScale = quantizeInt8(_cols, x.getData(), _input.data());
+    float sum = gemvInt8Fused(_rows, _cols, _weights.data(), _cols, _scales.data(), _input.data(), xScale,
+                              _bias->getData(), out.getData(), softmax ? GemvExp : GemvRelu);
+    if (softmax)
+    {
+        float *data = out.getData();
+        for (int i = 0; i < _rows; ++i)
+        {
+            data[i] = data[i] * (1 / sum);
+        }
+    }
+}
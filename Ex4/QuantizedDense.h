@@ -0,0 +1,52 @@
+/**
+ * @file QuantizedDense.h
+ * @author Ron Shuvy
+ * @brief This header file defines the int8 version of the Dense class
+ */
+
+#ifndef QUANTIZEDDENSE_H
+#define QUANTIZEDDENSE_H
+// ------------------------------ includes ------------------------------
+#include "Dense.h"
+#include <cstdint>
+#include <vector>
+// ------------------------------ method definitions -----------------------------
+
+/**
+ * @class QuantizedDense
+ * @brief a Dense whose weights are stored as int8, with a scale per row (symmetric post-training quantization:
+ *        w ~ scale * q, where the largest weight of the row is mapped to 127). each input is quantized
+ *        with a single scale of its own when the layer is applied, so the product is computed in integers.
+ */
+class QuantizedDense
+{
+private:
+    Activation _act; // activation function
+    int _rows, _cols;
+    std::vector<int8_t> _weights; // row-major quantized weights
+    std::vector<float> _scales; // the scale of each row
+    const Matrix *_bias; // bias matrix (not copied - must outlive the layer)
+    mutable std::vector<int8_t> _input; // the quantized input, reused by every call
+
+public:
+    /**
+     * @fn Constructor
+     * @brief quantizes the weights of a layer
+     */
+    explicit QuantizedDense(const Dense &dense);
+
+    /**
+     * @fn apply
+     * @brief calculates the result of the layer for a single input (a column vector) into out, which is
+     *        reallocated only if its size is different from the size of the result. not thread-safe.
+     */
+    void apply(const Matrix &x, Matrix &out) const;
+
+    /**
+     * @fn getWeightsBytes
+     * @return the size of the quantized weights and their scales, in bytes
+     */
+    size_t getWeightsBytes() const { return _weights.size() * sizeof(int8_t) + _scales.size() * sizeof(float); }
+};
+
+#endif //QUANTIZEDDENSE_H
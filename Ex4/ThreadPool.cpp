@@ -0,0 +1,174 @@
+/**
+ * @file ThreadPool.cpp
+ * @author Ron Shuvy
+ * @brief This file implements a work-stealing thread pool
+ */
+// ------------------------------ includes ------------------------------
+#include "ThreadPool.h"
+#include <algorithm>
+// -------------------------- const definitions -------------------------
+#define SPIN_TRIES 64 // times to yield and recheck before blocking - short tasks are picked up without a wakeup
+// ------------------------------ method definitions -----------------------------
+
+/**
+ * @fn Constructor
+ */
+ThreadPool::ThreadPool(int threads) : _queued(0), _pending(0), _next(0), _stop(false)
+{
+    if (threads <= 0)
+    {
+        threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i = 0; i < threads; ++i)
+    {
+        _queues.emplace_back(new WorkQueue);
+    }
+    for (int i = 0; i < threads; ++i)
+    {
+        _workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+/**
+ * @fn Destructor
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _taskAdded.notify_all();
+    for (std::thread &worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+/**
+ * @fn submit
+ * @brief adds a task to the queue of one of the workers
+ */
+void ThreadPool::submit(Task task)
+{
+    WorkQueue &queue = *_queues[_next++ % _queues.size()];
+    _pending++;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    _queued++;
+    // taking the lock makes sure a worker which is about to sleep sees the task, or gets the notification
+    std::lock_guard<std::mutex> lock(_mutex);
+    _taskAdded.notify_one();
+}
+
+/**
+ * @fn wait
+ * @brief blocks until all the submitted tasks are finished
+ */
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _allDone.wait(lock, [this] { return _pending == 0; });
+}
+
+/**
+ * @fn parallelFor
+ * @brief runs body(0), ..., body(count - 1) in parallel, and returns when all of them are finished
+ */
+void ThreadPool::parallelFor(int count, const std::function<void(int)> &body)
+{
+    std::mutex mutex;
+    std::condition_variable done;
+    std::atomic<int> remaining(count - 1);
+    for (int part = 1; part < count; ++part)
+    {
+        submit([&, part](int)
+               {
+                   body(part);
+                   // notified under the lock, so the caller cannot return (and destroy it) in between
+                   std::lock_guard<std::mutex> lock(mutex);
+                   if (--remaining == 0)
+                   {
+                       done.notify_one();
+                   }
+               });
+    }
+    if (count > 0)
+    {
+        body(0);
+    }
+    for (int i = 0; i < SPIN_TRIES && remaining > 0; ++i)
+    {
+        std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&remaining] { return remaining <= 0; });
+}
+
+/**
+ * @fn takeTask
+ * @brief takes a task from the worker's queue, or steals one from another queue
+ */
+bool ThreadPool::takeTask(int worker, Task &task)
+{
+    int count = (int)_queues.size();
+    for (int i = 0; i < count; ++i)
+    {
+        WorkQueue &queue = *_queues[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+        if (i == 0)
+        {
+            // the worker's own queue - the newest task (its data is the most likely to be cached)
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            // a victim's queue - the oldest task (the farthest from what the victim is working on)
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        _queued--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @fn workerLoop
+ * @brief the main loop of a worker thread
+ */
+void ThreadPool::workerLoop(int worker)
+{
+    while (true)
+    {
+        Task task;
+        if (takeTask(worker, task))
+        {
+            task(worker);
+            if (--_pending == 0)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _allDone.notify_all();
+            }
+            continue;
+        }
+
+        for (int i = 0; i < SPIN_TRIES && _queued <= 0; ++i)
+        {
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(_mutex);
+        _taskAdded.wait(lock, [this] { return _stop || _queued > 0; });
+        if (_stop && _queued <= 0)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file ThreadPool.h
+ * @author Ron Shuvy
+ * @brief This header file defines a work-stealing thread pool
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+// ------------------------------ includes ------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+// ------------------------------ class declaration -----------------------------
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of worker threads. every worker has its own queue of tasks - it runs the newest task of its
+ *        own queue, and when the queue is empty it steals the oldest task of another worker's queue.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief a task - gets the index of the worker which runs it (0 to size() - 1)
+     */
+    typedef std::function<void(int)> Task;
+
+private:
+    /**
+     * @struct WorkQueue
+     * @brief the task queue of a single worker
+     */
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> _queues; // a queue per worker
+    std::vector<std::thread> _workers;
+    std::atomic<int> _queued; // number of tasks in the queues
+    std::atomic<int> _pending; // number of submitted tasks which did not finish yet
+    std::atomic<unsigned int> _next; // the queue of the next submitted task (round-robin)
+    bool _stop;
+    std::mutex _mutex; // guards the sleeping and waking of the workers and of wait()
+    std::condition_variable _taskAdded;
+    std::condition_variable _allDone;
+
+    /**
+     * @fn takeTask
+     * @brief takes a task from the worker's queue, or steals one from another queue
+     * @return true if a task was taken
+     */
+    bool takeTask(int worker, Task &task);
+
+    /**
+     * @fn workerLoop
+     * @brief the main loop of a worker thread
+     */
+    void workerLoop(int worker);
+
+public:
+    /**
+     * @fn Constructor
+     * @param threads - number of workers (0 - the number of hardware threads)
+     */
+    explicit ThreadPool(int threads = 0);
+
+    /**
+     * @fn Destructor
+     * @brief finishes the submitted tasks and joins the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @fn Getters
+     */
+    int size() const { return (int)_workers.size(); }
+
+    /**
+     * @fn submit
+     * @brief adds a task to the queue of one of the workers
+     */
+    void submit(Task task);
+
+    /**
+     * @fn wait
+     * @brief blocks until all the submitted tasks are finished
+     */
+    void wait();
+
+    /**
+     * @fn parallelFor
+     * @brief runs body(0), ..., body(count - 1) in parallel - part 0 on the calling thread and the others on the
+     *        workers - and returns when all of them are finished (regardless of other submitted tasks).
+     */
+    void parallelFor(int count, const std::function<void(int)> &body);
+};
+
+#endif //THREADPOOL_H
@@ -0,0 +1,67 @@
+/**
+ * @file Workspace.cpp
+ * @author Ron Shuvy
+ * @brief This file implements the Workspace arena
+ */
+
+// ------------------------------ includes ------------------------------
+#include "Workspace.h"
+#include <algorithm>
+#include <cstdlib>
+// -------------------------- const definitions -------------------------
+#define ALIGNMENT_FLOATS (WORKSPACE_ALIGNMENT / sizeof(float))
+// ------------------------------ method definitions -----------------------------
+
+/**
+ * @fn Destructor
+ */
+Workspace::~Workspace()
+{
+    for (Block &block : _blocks)
+    {
+        std::free(block.data);
+    }
+}
+
+/**
+ * @fn allocate
+ * @return count uninitialized, aligned floats
+ */
+float *Workspace::allocate(size_t count)
+{
+    // whole cache lines, so the next allocation stays aligned
+    count = (count + ALIGNMENT_FLOATS - 1) / ALIGNMENT_FLOATS * ALIGNMENT_FLOATS;
+    while (_block < _blocks.size() && _offset + count > _blocks[_block].size)
+    {
+        ++_block, _offset = 0;
+    }
+    if (_block == _blocks.size())
+    {
+        // each block doubles the capacity, so a workload needs few blocks
+        size_t size = std::max(count, _blocks.empty() ? (size_t)WORKSPACE_BLOCK_SIZE : getCapacity());
+        float *data = (float *)std::aligned_alloc(WORKSPACE_ALIGNMENT, size * sizeof(float));
+        if (data == nullptr)
+        {
+            return nullptr;
+        }
+        _blocks.push_back({data, size});
+        _offset = 0;
+    }
+    float *result = _blocks[_block].data + _offset;
+    _offset += count;
+    return result;
+}
+
+/**
+ * @fn getCapacity
+ * @return the number of floats in the blocks
+ */
+size_t Workspace::getCapacity() const
+{
+    size_t capacity = 0;
+    for (const Block &block : _blocks)
+    {
+        capacity += block.size;
+    }
+    return capacity;
+}
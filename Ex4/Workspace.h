@@ -0,0 +1,120 @@
+/**
+ * @file Workspace.h
+ * @author Ron Shuvy
+ * @brief This header file defines a stack-like arena, from which Matrix temporaries can be allocated
+ */
+
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+// ------------------------------ includes ------------------------------
+#include <cstddef>
+#include <vector>
+// -------------------------- const definitions -------------------------
+#define WORKSPACE_ALIGNMENT 64 // bytes - every allocation starts on a cache line
+#define WORKSPACE_BLOCK_SIZE 65536 // floats of the first block
+// ------------------------------ class declaration -----------------------------
+
+/**
+ * @class Workspace
+ * @brief an arena of floats: an allocation bumps an offset in the current block (a new block is added only when
+ *        no block has room), and release() frees everything allocated after a mark at once. the blocks are kept,
+ *        so once a workload has run, running it again allocates nothing from the heap. not thread-safe - a
+ *        workspace belongs to a single thread.
+ *
+ * a Matrix takes its elements from a workspace only when the workspace is passed to its constructor (see
+ * Matrix(rows, cols, workspace)) - the heap is used otherwise. the expressions of the network have variants which
+ * take a workspace for their result: multiply and add (for operator* and operator+ of Matrix),
+ * Activation::operator()(mat, workspace) and Dense::operator()(x, workspace). the variants without a workspace
+ * allocate their result from the heap.
+ */
+class Workspace
+{
+public:
+    /**
+     * @struct Marker
+     * @brief a position in the workspace - see mark and release
+     */
+    struct Marker
+    {
+        size_t block, offset;
+    };
+
+    Workspace() : _block(0), _offset(0) {}
+    Workspace(const Workspace &) = delete;
+    Workspace &operator=(const Workspace &) = delete;
+
+    /**
+     * @fn Destructor
+     * @brief frees the blocks
+     */
+    ~Workspace();
+
+    /**
+     * @fn allocate
+     * @return count uninitialized floats, aligned to WORKSPACE_ALIGNMENT bytes, null if the heap is exhausted
+     */
+    float *allocate(size_t count);
+
+    /**
+     * @fn mark
+     * @return the current position, to release everything allocated after it
+     */
+    Marker mark() const { return {_block, _offset}; }
+
+    /**
+     * @fn release
+     * @brief frees (for reuse) everything allocated after a marker, in a single step
+     */
+    void release(const Marker &marker) { _block = marker.block, _offset = marker.offset; }
+
+    /**
+     * @fn getCapacity
+     * @return the number of floats in the blocks
+     */
+    size_t getCapacity() const;
+
+private:
+    /**
+     * @struct Block
+     * @brief an aligned block of floats
+     */
+    struct Block
+    {
+        float *data;
+        size_t size;
+    };
+
+    std::vector<Block> _blocks;
+    size_t _block; // the block of the next allocation
+    size_t _offset; // the next free float of the block
+};
+
+/**
+ * @class WorkspaceScope
+ * @brief marks a workspace, and releases everything allocated from it after the mark when the scope ends, so
+ *        the matrices of the workspace created inside the scope must not be used after it (copy a result to a
+ *        heap matrix to keep it). scopes may be nested.
+ */
+class WorkspaceScope
+{
+private:
+    Workspace &_workspace;
+    Workspace::Marker _marker; // the position of the workspace when the scope started
+
+public:
+    /**
+     * @fn Constructor
+     */
+    explicit WorkspaceScope(Workspace &workspace) : _workspace(workspace), _marker(workspace.mark()) {}
+
+    WorkspaceScope(const WorkspaceScope &) = delete;
+    WorkspaceScope &operator=(const WorkspaceScope &) = delete;
+
+    /**
+     * @fn Destructor
+     * @brief releases the allocations of the scope
+     */
+    ~WorkspaceScope() { _workspace.release(_marker); }
+};
+
+#endif //WORKSPACE_H
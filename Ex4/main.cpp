@@ -1,28 +1,70 @@
-#include <fstream>
-
 #include "Matrix.h"
 #include "Activation.h"
 #include "Dense.h"
 #include "MlpNetwork.h"
+#include "MappedFile.h"
+#include "ModelFile.h"
+#include "ImageStream.h"
+#include "InferenceEngine.h"
+#include <chrono>
 
 #define QUIT "q"
 #define INSERT_IMAGE_PATH "Please insert image path:"
 #define ERROR_INAVLID_PARAMETER "Error: invalid Parameters file for layer: "
 #define ERROR_INVALID_INPUT "Error: Failed to retrieve input. Exiting.."
 #define ERROR_INVALID_IMG "Error: invalid image path or size: "
+#define ERROR_INVALID_MODEL "Error: invalid model file: "
+#define ERROR_INVALID_SOURCE "Error: invalid images: "
+#define ERROR_INVALID_OUTPUT "Error: failed to write results to: "
 #define USAGE_MSG "Usage:\n" \
                   "\t./mlpnetwork w1 w2 w3 w4 b1 b2 b3 b4\n" \
                   "\twi - the i'th layer's weights\n" \
-                  "\tbi - the i'th layer's biases"
+                  "\tbi - the i'th layer's biases\n" \
+                  "\t./mlpnetwork model\n" \
+                  "\tmodel - a model file (see modelpack)\n" \
+                  "\t./mlpnetwork --batch source images format results (w1 w2 w3 w4 b1 b2 b3 b4 | model)\n" \
+                  "\tsource - dir (a directory of images), list (a file of image paths, one per line)\n" \
+                  "\t         or stream (a file of images one after the other, - for stdin)\n" \
+                  "\tformat - csv (lines 'image,digit,probability') or bin (a raw Digit struct of 8 bytes per image: the\n" \
+                  "\t         digit as an unsigned 32-bit int, then its probability as a 32-bit float, native-endian)\n" \
+                  "\tresults - the results file, - for stdout (throughput stats go to stderr)"
 
 
 #define ARGS_START_IDX 1
 #define ARGS_COUNT (ARGS_START_IDX + (MLP_SIZE * 2))
 #define WEIGHTS_START_IDX ARGS_START_IDX
 #define BIAS_START_IDX (ARGS_START_IDX + MLP_SIZE)
+#define MODEL_ARGS_COUNT (ARGS_START_IDX + 1)
+
+#define BATCH_FLAG "--batch"
+#define BATCH_SOURCE_IDX 2
+#define BATCH_IMAGES_IDX 3
+#define BATCH_FORMAT_IDX 4
+#define BATCH_RESULTS_IDX 5
+#define BATCH_ARGS_COUNT 5 // the flag and its arguments, which come before the network arguments
+#define BATCH_CHUNK 4096 // images read and classified at a time
+#define CSV_HEADER "image,digit,probability"
+#define STDOUT_PATH "-" // the results path of the standard output
+#define BIN_RECORD_SIZE 8 // bytes of a result in the bin format - a raw Digit struct
+static_assert(sizeof(Digit) == BIN_RECORD_SIZE, "a Digit is not the record of the bin format");
+
 
 
 
+/**
+ * The arguments of the batch mode.
+ * @var source - where the images come from
+ * @var images - the directory, list or stream of the images
+ * @var csv - whether the results are written as CSV (or as binary Digit structs)
+ * @var results - the results path
+ */
+struct BatchOptions
+{
+    ImageSource source;
+    std::string images;
+    bool csv;
+    std::string results;
+};
 
 /**
  * Prints program usage to stdout.
@@ -34,34 +76,18 @@ void usage()
 
 /**
  * Given a binary file path and a matrix,
- * reads the content of the file into the matrix.
- * file must match matrix in size in order to read successfully.
- * @param filePath - path of the binary file to read
- * @param mat -  matrix to read the file into.
+ * maps the file and makes the matrix a view of its content (no copy).
+ * file must match matrix in size in order to map successfully.
+ * @param filePath - path of the binary file to map
+ * @param file - the mapping, which must outlive the matrix
+ * @param mat -  matrix to view the file with (its size is kept).
  * @return boolean status
  *          true - success
  *          false - failure
  */
-bool readFileToMatrix(const std::string &filePath, Matrix &mat)
+bool mapFileToMatrix(const std::string &filePath, MappedFile &file, Matrix &mat)
 {
-    std::ifstream is;
-    is.open(filePath, std::ios::in | std::ios::binary | std::ios::ate);
-    if(!is.is_open())
-    {
-        return false;
-    }
-
-    long int matByteSize = (long int) mat.getCols() * mat.getRows() * sizeof(float);
-    if(is.tellg() != matByteSize)
-    {
-        is.close();
-        return false;
-    }
-
-    is.seekg(0, std::ios_base::beg);
-    is >> mat;
-    is.close();
-    return true;
+    return file.open(filePath) && file.view(mat.getRows(), mat.getCols(), mat);
 }
 
 /**
@@ -73,8 +99,10 @@ bool readFileToMatrix(const std::string &filePath, Matrix &mat)
  * @param weights array of matrix, weigths[i] is the i'th layer weights matrix
  * @param biases array of matrix, biases[i] is the i'th layer bias matrix
  *          (which is actually a vector)
+ * @param files the mappings of the parameters files, which the matrices view
  */
-void loadParameters(char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE], Matrix biases[MLP_SIZE])
+void loadParameters(char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE], Matrix biases[MLP_SIZE],
+                    MappedFile files[MLP_SIZE * 2])
 {
     for(int i = 0; i < MLP_SIZE; i++)
     {
@@ -84,8 +112,8 @@ void loadParameters(char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE], Matrix bi
         std::string weightsPath(paths[WEIGHTS_START_IDX + i]);
         std::string biasPath(paths[BIAS_START_IDX + i]);
 
-        if(!(readFileToMatrix(weightsPath, weights[i]) &&
-           readFileToMatrix(biasPath, biases[i])))
+        if(!(mapFileToMatrix(weightsPath, files[i], weights[i]) &&
+           mapFileToMatrix(biasPath, files[MLP_SIZE + i], biases[i])))
         {
             std::cerr << ERROR_INAVLID_PARAMETER << (i + 1) << std::endl;
             exit(EXIT_FAILURE);
@@ -94,6 +122,148 @@ void loadParameters(char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE], Matrix bi
     }
 }
 
+/**
+ * Maps a model file, and checks that it takes images as its input.
+ * Exits (code == 1) upon failures.
+ * @param path the model file path
+ * @param model the model file, which must outlive the network
+ */
+void loadModel(const std::string &path, ModelFile &model)
+{
+    if(!(model.open(path) && model.getWeights()[0].getCols() == imgDims.rows * imgDims.cols))
+    {
+        std::cerr << ERROR_INVALID_MODEL << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * Parses the arguments of the batch mode (which follow BATCH_FLAG).
+ * Exits (code == 1) with the program usage on invalid arguments.
+ * @param argv the program's arguments
+ * @return the batch options
+ */
+BatchOptions parseBatchArgs(char **argv)
+{
+    BatchOptions options;
+    std::string source(argv[BATCH_SOURCE_IDX]), format(argv[BATCH_FORMAT_IDX]);
+    if(source == "dir")
+    {
+        options.source = SourceDirectory;
+    }
+    else if(source == "list")
+    {
+        options.source = SourceList;
+    }
+    else if(source == "stream")
+    {
+        options.source = SourceStream;
+    }
+    else
+    {
+        usage();
+        exit(EXIT_FAILURE);
+    }
+    if(format != "csv" && format != "bin")
+    {
+        usage();
+        exit(EXIT_FAILURE);
+    }
+    options.csv = (format == "csv");
+    options.images = argv[BATCH_IMAGES_IDX];
+    options.results = argv[BATCH_RESULTS_IDX];
+    return options;
+}
+
+/**
+ * The batch mode of the program: classifies all of the images of a directory,
+ * list or stream, BATCH_CHUNK images at a time on all cores (see InferenceEngine),
+ * without rendering them, and writes a result per image.
+ * Prints the throughput to stderr.
+ * Exits (code == 1) if the images cannot be opened or the results cannot be written.
+ * @param mlp MlpNetwork to use in order to predict the images.
+ * @param options the batch options
+ */
+void mlpBatch(const MlpNetwork &mlp, const BatchOptions &options)
+{
+    std::ios::sync_with_stdio(false); // whole chunks are read from stdin and written to stdout
+    int pixels = imgDims.rows * imgDims.cols;
+    ImageStream stream;
+    if(!stream.open(options.source, options.images, pixels))
+    {
+        std::cerr << ERROR_INVALID_SOURCE << options.images << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::ofstream file;
+    std::ostream *results = &std::cout;
+    if(options.results != STDOUT_PATH)
+    {
+        file.open(options.results, std::ios::out | std::ios::binary);
+        if(!file.is_open())
+        {
+            std::cerr << ERROR_INVALID_OUTPUT << options.results << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        results = &file;
+    }
+    if(options.csv)
+    {
+        *results << CSV_HEADER << '\n';
+    }
+
+    InferenceEngine engine(mlp);
+    std::vector<float> chunk((size_t)BATCH_CHUNK * pixels);
+    std::vector<std::string> names;
+    std::vector<Matrix> images;
+    long total = 0;
+    std::chrono::duration<double> readTime(0), classifyTime(0);
+    auto start = std::chrono::steady_clock::now();
+    while(true)
+    {
+        auto readStart = std::chrono::steady_clock::now();
+        int count = stream.read(chunk.data(), BATCH_CHUNK, names);
+        auto classifyStart = std::chrono::steady_clock::now();
+        readTime += classifyStart - readStart;
+        if(count == 0)
+        {
+            break;
+        }
+
+        images.clear();
+        for(int i = 0; i < count; i++)
+        {
+            images.push_back(Matrix::view(chunk.data() + (size_t)i * pixels, pixels, 1));
+        }
+        std::vector<Digit> digits = engine.classify(images);
+        classifyTime += std::chrono::steady_clock::now() - classifyStart;
+
+        if(options.csv)
+        {
+            for(int i = 0; i < count; i++)
+            {
+                *results << names[i] << ',' << digits[i].value << ',' << digits[i].probability << '\n';
+            }
+        }
+        else
+        {
+            results->write((const char *)digits.data(), (long)(count * sizeof(Digit)));
+        }
+        total += count;
+    }
+    results->flush();
+    if(!results->good())
+    {
+        std::cerr << ERROR_INVALID_OUTPUT << options.results << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cerr << "Classified " << total << " images (" << stream.getSkipped() << " skipped) in "
+              << elapsed.count() << " s: " << total / elapsed.count() << " images/s"
+              << " (reading " << readTime.count() << " s, classifying " << classifyTime.count()
+              << " s on " << engine.getThreads() << " threads)" << std::endl;
+}
+
 /**
  * This programs Command line interface for the mlp network.
  * Looping on: {
@@ -107,6 +277,7 @@ void loadParameters(char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE], Matrix bi
 void mlpCli(MlpNetwork &mlp)
 {
     Matrix img(imgDims.rows, imgDims.cols);
+    MappedFile imgFile;
     std::string imgPath;
 
     std::cout << INSERT_IMAGE_PATH << std::endl;
@@ -119,10 +290,10 @@ void mlpCli(MlpNetwork &mlp)
 
     while(imgPath != QUIT)
     {
-        if(readFileToMatrix(imgPath, img))
+        if(mapFileToMatrix(imgPath, imgFile, img))
         {
-            Matrix imgVec = img;
-            Digit output = mlp(imgVec.vectorize());
+            Matrix imgVec = Matrix::view(img.getData(), img.getRows() * img.getCols(), 1);
+            Digit output = mlp(imgVec);
             std::cout << "Image processed:" << std::endl
                       << img << std::endl;
             std::cout << "Mlp result: " << output.value <<
@@ -143,6 +314,24 @@ void mlpCli(MlpNetwork &mlp)
     }
 }
 
+/**
+ * Runs the batch mode or the interactive mode of the program.
+ * @param mlp MlpNetwork to use
+ * @param batch whether to run the batch mode
+ * @param options the batch options (ignored by the interactive mode)
+ */
+void runMode(MlpNetwork &mlp, bool batch, const BatchOptions &options)
+{
+    if(batch)
+    {
+        mlpBatch(mlp, options);
+    }
+    else
+    {
+        mlpCli(mlp);
+    }
+}
+
 /**
  * Program's main
  * @param argc count of args
@@ -151,19 +340,38 @@ void mlpCli(MlpNetwork &mlp)
  */
 int main(int argc, char **argv)
 {
+    // in batch mode, the network arguments follow the batch arguments
+    bool batch = (argc > BATCH_ARGS_COUNT && std::string(argv[ARGS_START_IDX]) == BATCH_FLAG);
+    BatchOptions options = {};
+    if(batch)
+    {
+        options = parseBatchArgs(argv);
+        argc -= BATCH_ARGS_COUNT;
+        argv += BATCH_ARGS_COUNT;
+    }
+
+    if(argc == MODEL_ARGS_COUNT)
+    {
+        ModelFile model;
+        loadModel(argv[ARGS_START_IDX], model);
+        MlpNetwork mlp(model);
+        runMode(mlp, batch, options);
+        return EXIT_SUCCESS;
+    }
     if(argc != ARGS_COUNT)
     {
         usage();
         exit(EXIT_FAILURE);
     }
 
+    MappedFile files[MLP_SIZE * 2];
     Matrix weights[MLP_SIZE];
     Matrix biases[MLP_SIZE];
-    loadParameters(argv, weights, biases);
+    loadParameters(argv, weights, biases, files);
 
     MlpNetwork mlp(weights, biases);
 
-    mlpCli(mlp);
+    runMode(mlp, batch, options);
 
 
     return EXIT_SUCCESS;
@@ -0,0 +1,53 @@
+/**
+ * @file modelpack.cpp
+ * @author Ron Shuvy
+ * @brief converts the raw parameters files of the network (w1..w4, b1..b4) to a single model file
+ */
+// ------------------------------ includes ------------------------------
+#include "MlpNetwork.h"
+#include "ModelFile.h"
+// -------------------------- const definitions -------------------------
+#define ARGS_COUNT (2 + MLP_SIZE * 2)
+#define OUTPUT_IDX (1 + MLP_SIZE * 2)
+#define USAGE_MSG "Usage: ./modelpack w1 w2 w3 w4 b1 b2 b3 b4 model\n" \
+                  "\twi - the i'th layer's weights\n" \
+                  "\tbi - the i'th layer's biases\n" \
+                  "\tmodel - the model file to write"
+#define ERROR_INVALID_PARAMETER "Error: invalid Parameters file: "
+#define ERROR_WRITE "Error: failed to write "
+// ------------------------------ functions -----------------------------
+
+/**
+ * Program's main
+ */
+int main(int argc, char **argv)
+{
+    if (argc != ARGS_COUNT)
+    {
+        std::cout << USAGE_MSG << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    MappedFile files[MLP_SIZE * 2];
+    Matrix weights[MLP_SIZE], biases[MLP_SIZE];
+    for (int i = 0; i < MLP_SIZE; ++i)
+    {
+        if (!(files[i].open(argv[1 + i]) &&
+              files[i].view(weightsDims[i].rows, weightsDims[i].cols, weights[i])))
+        {
+            std::cerr << ERROR_INVALID_PARAMETER << argv[1 + i] << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (!(files[MLP_SIZE + i].open(argv[1 + MLP_SIZE + i]) &&
+              files[MLP_SIZE + i].view(biasDims[i].rows, biasDims[i].cols, biases[i])))
+        {
+            std::cerr << ERROR_INVALID_PARAMETER << argv[1 + MLP_SIZE + i] << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (!writeModelFile(argv[OUTPUT_IDX], weights, biases, defaultActivations, MLP_SIZE))
+    {
+        std::cerr << ERROR_WRITE << argv[OUTPUT_IDX] << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return EXIT_SUCCESS;
+}
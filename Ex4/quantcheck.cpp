@@ -0,0 +1,165 @@
+/**
+ * @file quantcheck.cpp
+ * @author Ron Shuvy
+ * @brief compares the reduced precision inference modes of MlpNetwork (fp16, bf16 and int8 weights) to the fp32
+ *        mode on a labeled set of digits: the accuracy of each mode, how often it agrees with fp32, the largest
+ *        difference of the probabilities, how often classifyBatch agrees with the mode on single images, the
+ *        time per image, the weight bytes read per image and the weight bytes kept in memory. every image is also checked with NOISY_COPIES noisy copies of itself.
+ */
+// ------------------------------ includes ------------------------------
+#include "MlpNetwork.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+// -------------------------- const definitions -------------------------
+#define ARGS_COUNT (2 + MLP_SIZE * 2)
+#define LABELS_IDX (1 + MLP_SIZE * 2)
+#define NOISY_COPIES 99
+#define NOISE_LEVEL 0.2f // the largest noise added to a pixel
+#define TIMING_ROUNDS 200
+#define USAGE_MSG "Usage: ./quantcheck w1 w2 w3 w4 b1 b2 b3 b4 labels\n" \
+                  "\tlabels - a file of lines 'image-path digit'"
+#define ERROR_FILE "Error: failed to read "
+// ------------------------------ functions -----------------------------
+
+/**
+ * @brief reads a binary file of floats into a matrix of the given size, exits on failure
+ */
+Matrix readMatrix(const std::string &path, int rows, int cols)
+{
+    Matrix mat(rows, cols);
+    std::ifstream is(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!is.is_open() || is.tellg() != (long)rows * cols * (long)sizeof(float))
+    {
+        std::cerr << ERROR_FILE << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    is.seekg(0, std::ios_base::beg);
+    is >> mat;
+    return mat;
+}
+
+/**
+ * @brief the average time of running the network on each of the images, in microseconds
+ */
+double timePerImage(const MlpNetwork &mlp, const std::vector<Matrix> &images)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < TIMING_ROUNDS; ++round)
+    {
+        for (const Matrix &img : images)
+        {
+            mlp(img);
+        }
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / ((double)TIMING_ROUNDS * images.size());
+}
+
+/**
+ * @brief prints the accuracy of a network, its agreement with the fp32 network, the agreement of its batches with
+ *        its single images, its time per image, and the size of the weights it reads per image and keeps in memory
+ * @param batch - the images, as the columns of a matrix
+ */
+void compare(const char *name, const MlpNetwork &mlp, const MlpNetwork &fp32, const std::vector<Matrix> &images,
+             const Matrix &batch, const std::vector<unsigned int> &digits)
+{
+    std::vector<Digit> batchDigits = mlp.classifyBatch(batch);
+    int correct = 0, agree = 0, batchAgree = 0;
+    float maxDiff = 0;
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        Digit a = fp32(images[i]), b = mlp(images[i]);
+        correct += (b.value == digits[i]);
+        agree += (a.value == b.value);
+        batchAgree += (batchDigits[i].value == b.value);
+        if (a.value == b.value)
+        {
+            maxDiff = std::max(maxDiff, std::fabs(a.probability - b.probability));
+        }
+    }
+    double time = timePerImage(mlp, images), fp32Time = timePerImage(fp32, images);
+    std::cout << name << ": accuracy " << correct << "/" << images.size()
+              << ", agreement with fp32 " << agree << "/" << images.size()
+              << ", max probability difference " << maxDiff
+              << ", batch agreement " << batchAgree << "/" << images.size()
+              << ", " << time << " us per image (x" << fp32Time / time << ")"
+              << ", reads " << mlp.getReadBytes() << " bytes of weights per image (x"
+              << (double)fp32.getReadBytes() / mlp.getReadBytes() << " fewer)"
+              << ", keeps " << mlp.getWeightsBytes() << " bytes of weights" << std::endl;
+}
+
+/**
+ * Program's main
+ */
+int main(int argc, char **argv)
+{
+    if (argc != ARGS_COUNT)
+    {
+        std::cout << USAGE_MSG << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    Matrix weights[MLP_SIZE], biases[MLP_SIZE];
+    for (int i = 0; i < MLP_SIZE; ++i)
+    {
+        weights[i] = readMatrix(argv[1 + i], weightsDims[i].rows, weightsDims[i].cols);
+        biases[i] = readMatrix(argv[1 + MLP_SIZE + i], biasDims[i].rows, biasDims[i].cols);
+    }
+
+    std::ifstream labels(argv[LABELS_IDX]);
+    if (!labels.is_open())
+    {
+        std::cerr << ERROR_FILE << argv[LABELS_IDX] << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    std::vector<Matrix> images;
+    std::vector<unsigned int> digits;
+    std::mt19937 random(0);
+    std::uniform_real_distribution<float> noise(-NOISE_LEVEL, NOISE_LEVEL);
+    std::string path;
+    unsigned int digit;
+    while (labels >> path >> digit)
+    {
+        Matrix img = readMatrix(path, imgDims.rows * imgDims.cols, 1);
+        for (int copy = 0; copy <= NOISY_COPIES; ++copy)
+        {
+            Matrix noisy = img;
+            for (int i = 0; copy > 0 && i < noisy.getRows(); ++i)
+            {
+                noisy[i] = std::min(std::max(noisy[i] + noise(random), 0.f), 1.f);
+            }
+            images.push_back(noisy);
+            digits.push_back(digit);
+        }
+    }
+
+    // the 16-bit networks are built on a copy of the fp32 weights, which is released once they have their own
+    std::vector<Matrix> halfSource(weights, weights + MLP_SIZE);
+    int pixels = imgDims.rows * imgDims.cols, count = (int)images.size();
+    Matrix batch(pixels, count);
+    for (int j = 0; j < count; ++j)
+    {
+        for (int p = 0; p < pixels; ++p)
+        {
+            batch.getData()[p * count + j] = images[j][p];
+        }
+    }
+
+    MlpNetwork fp32(weights, biases), fp16(halfSource.data(), biases), bf16(halfSource.data(), biases);
+    MlpNetwork int8(weights, biases);
+    fp16.storeHalf(Fp16);
+    bf16.storeHalf(Bf16);
+    halfSource.clear();
+    halfSource.shrink_to_fit();
+    int8.quantize();
+    std::cout << "images: " << images.size() << std::endl;
+    compare("fp32", fp32, fp32, images, batch, digits);
+    compare("fp16", fp16, fp32, images, batch, digits);
+    compare("bf16", bf16, fp32, images, batch, digits);
+    compare("int8", int8, fp32, images, batch, digits);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file workspacebench.cpp
+ * @author Ron Shuvy
+ * @brief checks that MlpNetwork runs on its workspaces without allocating from the heap: operator() on an image,
+ *        and classifyBatch on a batch with a reused workspace (after a first batch). so do the workspace variants
+ *        of the expressions of a layer (Dense, multiply, add and Activation). prints the heap allocations and the
+ *        time per image of each, and of classifyBatch with a new workspace per batch.
+ */
+// ------------------------------ includes ------------------------------
+#include "MlpNetwork.h"
+#include "MappedFile.h"
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <string>
+// -------------------------- const definitions -------------------------
+#define PARAMS_COUNT (MLP_SIZE * 2)
+#define TIMING_ROUNDS 2000
+#define USAGE_MSG "Usage: ./workspacebench w1 w2 w3 w4 b1 b2 b3 b4 image [image ...]"
+#define ERROR_FILE "Error: failed to read "
+#define ERROR_ALLOCATIONS "Error: the inference allocated from the heap"
+// ------------------------------ globals -----------------------------
+static long heapAllocations = 0; // the calls of operator new (every new expression and container allocation)
+// ------------------------------ functions -----------------------------
+
+/**
+ * @brief counts the heap allocations (the array and nothrow forms of operator new call this one)
+ */
+void *operator new(std::size_t size)
+{
+    ++heapAllocations;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+/**
+ * @brief frees the memory of operator new
+ */
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * @brief frees the memory of operator new
+ */
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * @brief maps a binary file of floats as a matrix of the given size, exits on failure
+ */
+void mapMatrix(const std::string &path, int rows, int cols, MappedFile &file, Matrix &mat)
+{
+    if (!file.open(path) || !file.view(rows, cols, mat))
+    {
+        std::cerr << ERROR_FILE << path << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief calls run TIMING_ROUNDS times, and prints the heap allocations and the time per image of a call
+ * @return the heap allocations of a call
+ */
+template <typename Run>
+long measure(const char *name, int images, Run run)
+{
+    long allocations = heapAllocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < TIMING_ROUNDS; ++round)
+    {
+        run();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    allocations = (heapAllocations - allocations) / TIMING_ROUNDS;
+    std::cout << name << ": " << allocations << " heap allocations per call, "
+              << elapsed.count() / ((double)TIMING_ROUNDS * images) << " us per image" << std::endl;
+    return allocations;
+}
+
+/**
+ * Program's main
+ */
+int main(int argc, char **argv)
+{
+    if (argc < PARAMS_COUNT + 2)
+    {
+        std::cout << USAGE_MSG << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    MappedFile files[PARAMS_COUNT];
+    Matrix weights[MLP_SIZE], biases[MLP_SIZE];
+    for (int i = 0; i < MLP_SIZE; ++i)
+    {
+        mapMatrix(argv[1 + i], weightsDims[i].rows, weightsDims[i].cols, files[i], weights[i]);
+        mapMatrix(argv[1 + MLP_SIZE + i], biasDims[i].rows, biasDims[i].cols, files[MLP_SIZE + i], biases[i]);
+    }
+    int pixels = imgDims.rows * imgDims.cols, count = argc - PARAMS_COUNT - 1;
+    Matrix img(pixels, 1), batch(pixels, count);
+    for (int j = 0; j < count; ++j)
+    {
+        // the j-th image is the j-th column of the batch, and the first one is also copied to img
+        MappedFile file;
+        Matrix view;
+        mapMatrix(argv[PARAMS_COUNT + 1 + j], pixels, 1, file, view);
+        for (int p = 0; p < pixels; ++p)
+        {
+            batch.getData()[p * count + j] = view[p];
+        }
+        if (j == 0)
+        {
+            img = view;
+        }
+    }
+
+    MlpNetwork mlp(weights, biases);
+    Workspace workspace;
+    std::vector<Digit> digits(count);
+    mlp.classifyBatch(batch, workspace, digits.data());
+    size_t capacity = workspace.getCapacity();
+
+    long single = measure("operator()", 1, [&mlp, &img]() { mlp(img); });
+    long reused = measure("classifyBatch, reused workspace", count, [&mlp, &batch, &workspace, &digits]()
+                          {
+                              mlp.classifyBatch(batch, workspace, digits.data());
+                          });
+    measure("classifyBatch, new workspace", count, [&mlp, &batch]() { mlp.classifyBatch(batch); });
+    std::cout << "workspace: " << workspace.getCapacity() * sizeof(float) << " bytes" << std::endl;
+
+    // the first layer, as a Dense and as the expression W * x + b, then relu
+    Dense dense(&weights[0], &biases[0], Relu);
+    Activation relu(Relu);
+    Workspace expressionWorkspace;
+    auto layer = [&dense, &relu, &weights, &biases, &img, &expressionWorkspace]()
+    {
+        WorkspaceScope scope(expressionWorkspace);
+        dense(img, expressionWorkspace);
+        relu(add(multiply(weights[0], img, expressionWorkspace), biases[0], expressionWorkspace), expressionWorkspace);
+        multiply(img, 2, expressionWorkspace);
+    };
+    layer();
+    long expressions = measure("expressions of a layer, workspace", 1, layer);
+    if (single != 0 || reused != 0 || expressions != 0 || workspace.getCapacity() != capacity)
+    {
+        std::cerr << ERROR_ALLOCATIONS << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}